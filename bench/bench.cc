@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+#include <llvm-c/Target.h>
+#include <llvm/Support/DynamicLibrary.h>
+
+int main(int argc, char *argv[]) {
+    LLVMInitializeNativeTarget();
+    LLVMInitializeNativeAsmPrinter();
+    llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
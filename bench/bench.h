@@ -0,0 +1,101 @@
+// ---------------------------------------------------------------------------
+#ifndef BENCH_BENCH_H_
+#define BENCH_BENCH_H_
+// ---------------------------------------------------------------------------
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <x86intrin.h>
+
+#include "generator/input_generator.h"
+#include "parabix/bit.h"
+#include "stream/bit_stream.h"
+// ---------------------------------------------------------------------------
+namespace bench {
+// ---------------------------------------------------------------------------
+/// Working set sizes that fit into L1, into L2 and that have to be streamed from DRAM.
+const int64_t L1_BYTES = 16LL << 10;
+const int64_t L2_BYTES = 256LL << 10;
+const int64_t DRAM_BYTES = 64LL << 20;
+// ---------------------------------------------------------------------------
+/// Register the L1, L2 and DRAM resident working set sizes.
+inline void working_sets(benchmark::internal::Benchmark* b) {
+  b->Arg(L1_BYTES)->Arg(L2_BYTES)->Arg(DRAM_BYTES);
+}
+// ---------------------------------------------------------------------------
+/// Time stamp counter cycles, the reference clock of the cpu.
+class CycleCounter {
+  public:
+    CycleCounter()
+      : start(__rdtsc()) {}
+
+    [[nodiscard]] uint64_t cycles() const { return __rdtsc() - start; }
+
+  private:
+    uint64_t start;
+};
+// ---------------------------------------------------------------------------
+/// Report the throughput and the cycles per input byte.
+inline void report(benchmark::State& state, uint64_t cycles, uint64_t bytes_per_iteration) {
+  auto bytes = static_cast<double>(state.iterations()) * static_cast<double>(bytes_per_iteration);
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+  state.counters["cycles/byte"] = bytes > 0 ? static_cast<double>(cycles) / bytes : 0;
+}
+// ---------------------------------------------------------------------------
+/// Generated text with matches of the pattern, padded for the 64 byte reads of the last block.
+inline std::string text(size_t size, const char* pattern = "a[0-9]*z") {
+  generator::InputGenerator::Options options;
+  options.pattern = pattern;
+  auto input = generator::InputGenerator(options).generate(size);
+  input.resize(size);
+  input.append(64, '\0');
+  return input;
+}
+// ---------------------------------------------------------------------------
+/// Basis bit streams of the text, one array of 8 words per 63 byte block.
+inline std::vector<std::array<uint64_t, 8>> basis(const std::string& input, size_t size) {
+  std::vector<std::array<uint64_t, 8>> blocks((size + 62) / 63);
+  std::array<uint8_t, 64> output;
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    parabix::transpose_sse(const_cast<char*>(input.data()) + b * 63, output.data());
+    for (auto i = 0, j = 7; i < 8; ++i, --j) {
+      blocks[b][i] = *reinterpret_cast<uint64_t*>(&output[static_cast<unsigned>(j * 8)]) & ~(1ULL << 63);
+    }
+  }
+  return blocks;
+}
+// ---------------------------------------------------------------------------
+/// Random bit stream covering the given number of positions, set with the given density in 1/8.
+/// Streams are cached since filling the DRAM sized ones bit by bit takes a while.
+inline const stream::BitStream& bit_stream(size_t positions, unsigned density, uint64_t seed) {
+  static std::map<std::tuple<size_t, unsigned, uint64_t>, stream::BitStream> cache;
+  auto [it, inserted] = cache.try_emplace({positions, density, seed}, positions);
+  if (inserted) {
+    generator::Random random(seed);
+    for (size_t i = 0; i < positions; ++i) {
+      if (random.uniform(8) < density) {
+        it->second.set(i, true);
+      }
+    }
+  }
+  return it->second;
+}
+// ---------------------------------------------------------------------------
+/// Random byte per position stream with the given density in 1/8.
+inline std::vector<uint8_t> byte_stream(size_t positions, unsigned density, uint64_t seed) {
+  generator::Random random(seed);
+  std::vector<uint8_t> result(positions);
+  for (auto& value : result) {
+    value = random.uniform(8) < density;
+  }
+  return result;
+}
+// ---------------------------------------------------------------------------
+} // namespace bench
+// ---------------------------------------------------------------------------
+#endif  // BENCH_BENCH_H_
+// ---------------------------------------------------------------------------
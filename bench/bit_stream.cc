@@ -0,0 +1,80 @@
+#include "bench/bench.h"
+
+using BitStream = stream::BitStream;
+
+namespace {
+
+  // the working set is the size of a single stream, throughput is reported per covered input byte
+  size_t positions(benchmark::State& state) {
+    return static_cast<size_t>(state.range(0)) * 8;
+  }
+
+  template <typename Operation>
+  void run(benchmark::State& state, Operation&& operation) {
+    auto n = positions(state);
+    auto a = bench::bit_stream(n, 4, 1);
+    auto b = bench::bit_stream(n, 4, 2);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+      bench::CycleCounter counter;
+      operation(a, b);
+      cycles += counter.cycles();
+    }
+    bench::report(state, cycles, n);
+  }
+
+  void BM_BitStreamAnd(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream& b) { auto c = a & b; benchmark::DoNotOptimize(c); });
+  }
+
+  void BM_BitStreamOr(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream& b) { auto c = a | b; benchmark::DoNotOptimize(c); });
+  }
+
+  void BM_BitStreamXor(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream& b) { auto c = a ^ b; benchmark::DoNotOptimize(c); });
+  }
+
+  void BM_BitStreamNot(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream&) { auto c = ~a; benchmark::DoNotOptimize(c); });
+  }
+
+  void BM_BitStreamAdd(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream& b) { auto c = a + b; benchmark::DoNotOptimize(c); });
+  }
+
+  void BM_BitStreamShift(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream&) { auto c = a >> 1; benchmark::DoNotOptimize(c); });
+  }
+
+  void BM_BitStreamAndAssign(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream& b) { a &= b; benchmark::DoNotOptimize(a); });
+  }
+
+  void BM_BitStreamAddAssign(benchmark::State& state) {
+    run(state, [](BitStream& a, BitStream& b) { a += b; benchmark::DoNotOptimize(a); });
+  }
+
+  void BM_BitStreamAssignAnd(benchmark::State& state) {
+    BitStream c;
+    run(state, [&](BitStream& a, BitStream& b) { c.assign_and(a, b); benchmark::DoNotOptimize(c); });
+  }
+
+  void BM_BitStreamAssignShift(benchmark::State& state) {
+    BitStream c;
+    run(state, [&](BitStream& a, BitStream&) { c.assign_shift(a, 1); benchmark::DoNotOptimize(c); });
+  }
+
+} // namespace
+
+BENCHMARK(BM_BitStreamAnd)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamOr)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamXor)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamNot)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamAdd)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamShift)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamAndAssign)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamAddAssign)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamAssignAnd)->Apply(bench::working_sets);
+BENCHMARK(BM_BitStreamAssignShift)->Apply(bench::working_sets);
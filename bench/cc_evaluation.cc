@@ -0,0 +1,70 @@
+#include <algorithm>
+#include "bench/bench.h"
+#include "codegen/bytecode_compiler.h"
+#include "codegen/cc_compiler.h"
+#include "codegen/expression_compiler_cpp.h"
+#include "parser/re_parser.h"
+
+namespace {
+
+  void BM_ExpressionCompilerCppExecute(benchmark::State& state, const char* cc_pattern) {
+    auto size = static_cast<size_t>(state.range(0)) / 63 * 63;
+    auto input = bench::text(size);
+    auto blocks = bench::basis(input, size);
+
+    parser::ReParser parser;
+    codegen::CCCompiler cc_compiler;
+    auto expression = cc_compiler.compile(parser.parse(cc_pattern)[0]);
+    codegen::ExpressionCompilerCpp expr_compiler_cpp;
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+      bench::CycleCounter counter;
+      for (auto& basis : blocks) {
+        benchmark::DoNotOptimize(expr_compiler_cpp.execute(basis, expression.get()));
+      }
+      cycles += counter.cycles();
+    }
+    bench::report(state, cycles, size);
+  }
+
+  void BM_BytecodeExecute(benchmark::State& state, const char* cc_pattern) {
+    auto size = static_cast<size_t>(state.range(0)) / 63 * 63;
+    auto input = bench::text(size);
+    auto blocks = bench::basis(input, size);
+
+    parser::ReParser parser;
+    codegen::CCCompiler cc_compiler;
+    std::vector<std::unique_ptr<codegen::BitwiseExpression>> expressions;
+    expressions.push_back(cc_compiler.compile(parser.parse(cc_pattern)[0]));
+    codegen::BytecodeCompiler bytecode_compiler;
+    auto bytecode = bytecode_compiler.compile(expressions);
+    std::vector<uint64_t> registers(bytecode.getRegisterCount() * codegen::Bytecode::BATCH, 0);
+    std::fill_n(registers.begin() + codegen::Bytecode::ONES * codegen::Bytecode::BATCH, codegen::Bytecode::BATCH, ~0ULL);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+      bench::CycleCounter counter;
+      for (size_t first = 0; first < blocks.size(); first += codegen::Bytecode::BATCH) {
+        auto count = std::min(codegen::Bytecode::BATCH, blocks.size() - first);
+        for (size_t block = 0; block < count; ++block) {
+          for (size_t bit = 0; bit < 8; ++bit) {
+            registers[bit * codegen::Bytecode::BATCH + block] = blocks[first + block][bit];
+          }
+        }
+        bytecode.execute(registers.data());
+        benchmark::DoNotOptimize(registers.data());
+      }
+      cycles += counter.cycles();
+    }
+    bench::report(state, cycles, size);
+  }
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ExpressionCompilerCppExecute, single, "a")->Apply(bench::working_sets);
+BENCHMARK_CAPTURE(BM_ExpressionCompilerCppExecute, range, "[0-9]")->Apply(bench::working_sets);
+BENCHMARK_CAPTURE(BM_ExpressionCompilerCppExecute, ranges, "[a-zA-Z0-9]")->Apply(bench::working_sets);
+BENCHMARK_CAPTURE(BM_BytecodeExecute, single, "a")->Apply(bench::working_sets);
+BENCHMARK_CAPTURE(BM_BytecodeExecute, range, "[0-9]")->Apply(bench::working_sets);
+BENCHMARK_CAPTURE(BM_BytecodeExecute, ranges, "[a-zA-Z0-9]")->Apply(bench::working_sets);
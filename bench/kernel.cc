@@ -0,0 +1,36 @@
+#include "bench/bench.h"
+#include "codegen/parabix_compiler.h"
+#include "parser/re_parser.h"
+
+namespace {
+
+  void BM_ParabixCompilerRun(benchmark::State& state, const char* pattern) {
+    auto size = static_cast<size_t>(state.range(0)) / 63 * 63;
+    auto input = bench::text(size, pattern);
+    auto blocks = bench::basis(input, size);
+
+    parser::ReParser parser;
+    auto cc_list = parser.parse(pattern);
+    llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
+    codegen::ParabixCompiler compiler(context);
+    compiler.compile(cc_list);
+
+    std::vector<uint64_t> cc(cc_list.size());
+    std::vector<uint64_t> carry(cc_list.size());
+    std::vector<uint64_t> marker(cc_list.size() + 1);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+      bench::CycleCounter counter;
+      for (auto& basis : blocks) {
+        benchmark::DoNotOptimize(compiler.run(basis.data(), cc.data(), marker.data(), carry.data()));
+      }
+      cycles += counter.cycles();
+    }
+    bench::report(state, cycles, size);
+  }
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ParabixCompilerRun, short, "a[0-9]*z")->Apply(bench::working_sets);
+BENCHMARK_CAPTURE(BM_ParabixCompilerRun, long, "ab[c-e]*f[0-9][0-9]x*yz")->Apply(bench::working_sets);
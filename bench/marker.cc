@@ -0,0 +1,51 @@
+#include "bench/bench.h"
+#include "operations/marker.h"
+#include "operations/simd.h"
+
+namespace {
+
+  // the working set is the size of a single stream, throughput is reported per covered input byte
+  size_t positions(benchmark::State& state) {
+    return static_cast<size_t>(state.range(0)) * 8;
+  }
+
+  template <BitStream (*Operation)(const BitStream&, BitStream&)>
+  void BM_Marker(benchmark::State& state) {
+    auto n = positions(state);
+    auto marker = bench::bit_stream(n, 1, 1);
+    auto cc = bench::bit_stream(n, 4, 2);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+      bench::CycleCounter counter;
+      auto result = Operation(marker, cc);
+      benchmark::DoNotOptimize(result);
+      cycles += counter.cycles();
+    }
+    bench::report(state, cycles, n);
+  }
+
+  template <std::vector<uint8_t> (*Operation)(const std::vector<uint8_t>&, const std::vector<uint8_t>&)>
+  void BM_Simd(benchmark::State& state) {
+    // one byte per position
+    auto n = static_cast<size_t>(state.range(0));
+    auto marker = bench::byte_stream(n, 1, 1);
+    auto cc = bench::byte_stream(n, 4, 2);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+      bench::CycleCounter counter;
+      auto result = Operation(marker, cc);
+      benchmark::DoNotOptimize(result.data());
+      cycles += counter.cycles();
+    }
+    bench::report(state, cycles, n);
+  }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Marker, operation::marker::advance)->Apply(bench::working_sets);
+BENCHMARK_TEMPLATE(BM_Marker, operation::marker::match_star)->Apply(bench::working_sets);
+BENCHMARK_TEMPLATE(BM_Marker, operation::marker::scan_thru)->Apply(bench::working_sets);
+BENCHMARK_TEMPLATE(BM_Simd, operation::simd::advance)->Apply(bench::working_sets);
+BENCHMARK_TEMPLATE(BM_Simd, operation::simd::match_star)->Apply(bench::working_sets);
@@ -0,0 +1,24 @@
+#include "bench/bench.h"
+
+namespace {
+
+  void BM_TransposeSSE(benchmark::State& state) {
+    auto size = static_cast<size_t>(state.range(0)) / 63 * 63;
+    auto input = bench::text(size);
+    std::array<uint8_t, 64> output;
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+      bench::CycleCounter counter;
+      for (size_t i = 0; i < size; i += 63) {
+        parabix::transpose_sse(input.data() + i, output.data());
+        benchmark::DoNotOptimize(output.data());
+      }
+      cycles += counter.cycles();
+    }
+    bench::report(state, cycles, size);
+  }
+
+} // namespace
+
+BENCHMARK(BM_TransposeSSE)->Apply(bench::working_sets);
@@ -0,0 +1,26 @@
+# The generator and the runtime headers of ahead-of-time compiled matchers
+set(PARABIX_INCLUDE_DIR "${CMAKE_CURRENT_LIST_DIR}/../include")
+
+# Add a static library with the scan kernel of a fixed set of patterns, generated at build time.
+# The kernel is declared in <target>.h within the namespace <target> and does not link LLVM.
+#   parabix_add_matcher(rules "a[0-9]*z" "ab[c-e]*f")
+function(parabix_add_matcher TARGET)
+    set(PATTERNS ${ARGN})
+    if(NOT PATTERNS)
+        message(FATAL_ERROR "parabix_add_matcher(${TARGET}) without patterns")
+    endif()
+
+    set(OUTPUT_DIR "${CMAKE_CURRENT_BINARY_DIR}/${TARGET}")
+    file(MAKE_DIRECTORY ${OUTPUT_DIR})
+    add_custom_command(
+        OUTPUT "${OUTPUT_DIR}/${TARGET}.h" "${OUTPUT_DIR}/${TARGET}.cc"
+        COMMAND parabix_generate "--name=${TARGET}" "--output=${OUTPUT_DIR}" ${PATTERNS}
+        DEPENDS parabix_generate
+        COMMENT "Generating the matcher ${TARGET}"
+        VERBATIM
+    )
+
+    add_library(${TARGET} STATIC "${OUTPUT_DIR}/${TARGET}.cc" "${OUTPUT_DIR}/${TARGET}.h")
+    target_include_directories(${TARGET} PUBLIC ${OUTPUT_DIR} PRIVATE ${PARABIX_INCLUDE_DIR})
+    target_compile_options(${TARGET} PRIVATE -mpopcnt)
+endfunction()
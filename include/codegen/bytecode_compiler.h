@@ -0,0 +1,85 @@
+#ifndef INCLUDE_CODEGEN_BYTECODE_COMPILER_H_
+#define INCLUDE_CODEGEN_BYTECODE_COMPILER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "codegen/ast.h"
+
+namespace codegen {
+
+  /// A flat register program of character class expressions, evaluated for a batch of blocks at once.
+  /// Every register holds one word per block of the batch, so an instruction is dispatched once per batch
+  /// and its loop over the blocks runs on vector registers.
+  class Bytecode {
+    public:
+    /// Number of blocks of a batch.
+    static constexpr size_t BATCH = 64;
+    /// The registers in front of the instructions' results: the basis bits, all zeros and all ones.
+    static constexpr uint16_t ZERO = ENCODING_BITS;
+    static constexpr uint16_t ONES = ENCODING_BITS + 1;
+    static constexpr uint16_t FIRST_RESULT = ENCODING_BITS + 2;
+
+    enum class Op : uint8_t {
+      /// left & right
+      And,
+      /// left & ~right
+      AndNot,
+      /// left | right
+      Or,
+      /// ~left
+      Not,
+      /// (left & right) | (~left & other)
+      Select,
+    };
+
+    struct Instruction {
+      Op op;
+      uint16_t result;
+      uint16_t left;
+      uint16_t right;
+      uint16_t other;
+    };
+
+    /// Run the instructions, `registers` holds BATCH words per register and the basis bits of the batch.
+    void execute(uint64_t* registers) const;
+
+    /// Number of registers, the basis bits and the constants included.
+    [[nodiscard]] size_t getRegisterCount() const { return register_count; }
+    /// The register of each compiled expression.
+    [[nodiscard]] const std::vector<uint16_t>& getOutputs() const { return outputs; }
+    /// The instructions.
+    [[nodiscard]] const std::vector<Instruction>& getInstructions() const { return instructions; }
+
+    private:
+    friend class BytecodeCompiler;
+
+    std::vector<Instruction> instructions;
+    std::vector<uint16_t> outputs;
+    size_t register_count = FIRST_RESULT;
+  };
+
+  class BytecodeCompiler {
+    public:
+
+    /// Compile the expressions into a single program, equal subexpressions of all expressions are computed once.
+    Bytecode compile(const std::vector<std::unique_ptr<BitwiseExpression>>& expressions);
+
+    private:
+    uint16_t compileExpression(BitwiseExpression* expression);
+
+    /// Emit an instruction unless an equal one was emitted before, returns its register.
+    uint16_t emit(Bytecode::Op op, uint16_t left, uint16_t right = 0, uint16_t other = 0);
+
+    /// The program under construction.
+    Bytecode bytecode;
+    /// The register of every emitted instruction.
+    std::map<std::tuple<Bytecode::Op, uint16_t, uint16_t, uint16_t>, uint16_t> values;
+  };
+
+} // namespace codegen
+
+#endif  // INCLUDE_CODEGEN_BYTECODE_COMPILER_H_
@@ -3,8 +3,10 @@
 
 #include "codegen/ast.h"
 #include "codegen/jit.h"
+#include <memory>
 #include <unordered_map>
 #include <sstream>
+#include <vector>
 
 namespace codegen {
   
@@ -14,6 +16,10 @@ namespace codegen {
 
       std::string compile(BitwiseExpression& expression);
 
+      /// Emit the statements of a block function that compute the expressions on the basis bit streams `bit_0` to `bit_7`,
+      /// `bit_0` holds the most significant bit. Equal subexpressions are assigned once, expression i ends up in `cc_<i>`.
+      std::string compile(const std::vector<std::unique_ptr<BitwiseExpression>>& expressions);
+
       uint64_t execute(std::array<uint64_t, 8>& basis, BitwiseExpression* expression);
 
     private:
@@ -30,6 +36,7 @@ namespace codegen {
       void reset() noexcept {
        variable_counter = 0;
        variables.clear();
+       output.str("");
        output.clear();
       }
   };
@@ -21,7 +21,24 @@
 
 namespace codegen {
 
+    /// The optimization level used for both the IR pipeline and the machine code generator.
+    enum class OptimizationLevel {
+        O0,
+        O1,
+        O2,
+        O3,
+    };
+
     class JIT {
+        public:
+        /// Statistics of the materialized modules.
+        struct Statistics {
+            /// Time spent in the optimization pipeline.
+            double optimize_seconds = 0;
+            /// Size of the emitted code sections in bytes.
+            uint64_t code_size = 0;
+        };
+
         private:
         /// The target machine.
         std::unique_ptr<llvm::TargetMachine> target_machine;
@@ -31,6 +48,10 @@ namespace codegen {
         llvm::orc::ExecutionSession execution_session;
         /// The context
         llvm::orc::ThreadSafeContext& context;
+        /// The optimization level
+        OptimizationLevel level;
+        /// The statistics
+        Statistics statistics;
 
         /// Optimization function using OptimizeFunction = std::function<std::unique_ptr<llvm::Module>(std::unique_ptr<llvm::Module>)>;
 
@@ -45,7 +66,7 @@ namespace codegen {
 
         public:
         /// The constructor.
-        explicit JIT(llvm::orc::ThreadSafeContext& ctx);
+        explicit JIT(llvm::orc::ThreadSafeContext& ctx, OptimizationLevel level = OptimizationLevel::O2);
 
         ~JIT() {
           if (auto error = execution_session.endSession()) {
@@ -55,6 +76,10 @@ namespace codegen {
 
         /// Get the target machine.
         auto& getTargetMachine() { return *target_machine; }
+        /// Get the optimization level.
+        [[nodiscard]] OptimizationLevel getOptimizationLevel() const { return level; }
+        /// Get the statistics of the modules materialized so far.
+        [[nodiscard]] const Statistics& getStatistics() const { return statistics; }
         /// Add a module.
         llvm::Error addModule(std::unique_ptr<llvm::Module> module);
 
@@ -0,0 +1,28 @@
+#ifndef INCLUDE_CODEGEN_KERNEL_COMPILER_CPP_H_
+#define INCLUDE_CODEGEN_KERNEL_COMPILER_CPP_H_
+
+#include <string>
+#include <vector>
+
+namespace codegen {
+
+  /// Generates the C++ source of a complete scan kernel for a fixed set of patterns, ahead of time.
+  /// The kernel transposes the input, evaluates the character classes of all patterns once per block
+  /// and runs the marker operations of every pattern. It needs neither LLVM nor a compile step at startup.
+  class KernelCompilerCpp {
+    public:
+    /// The generated files.
+    struct Kernel {
+      /// Declares the functions in the namespace of the kernel name.
+      std::string header;
+      /// Defines them, includes the header as `<name>.h`.
+      std::string source;
+    };
+
+    /// Generate the kernel of the patterns, the name must be a C++ identifier.
+    Kernel compile(const std::string& name, const std::vector<std::string>& patterns);
+  };
+
+} // namespace codegen
+
+#endif  // INCLUDE_CODEGEN_KERNEL_COMPILER_CPP_H_
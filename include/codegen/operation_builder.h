@@ -17,6 +17,9 @@ namespace codegen {
 
       std::pair<llvm::Value*, llvm::Value*>  codegen(const parser::CC& cc, llvm::Value* cc_bit_stream, llvm::Value* marker_bit_stream, llvm::Value* carry);
 
+      /// (marker + cc) & ~cc, moves every marker to the end of its run of cc positions.
+      std::pair<llvm::Value*, llvm::Value*> buildScanThru(llvm::Value* CC, llvm::Value* M, llvm::Value* CARRY);
+
     private:
       std::pair<llvm::Value*, llvm::Value*> buildAdvance(llvm::Value* CC, llvm::Value* M, llvm::Value* CARRY);
 
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <optional>
 
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Value.h>
@@ -20,18 +21,45 @@ namespace codegen {
       uint8_t carry;
     };
 
-    explicit ParabixCompiler(llvm::orc::ThreadSafeContext& context)
+    /// Statistics of the compilation phases.
+    struct CompileStatistics {
+      /// Time spent in CCCompiler::compile.
+      double cc_compile_seconds = 0;
+      /// Time spent building the IR.
+      double ir_build_seconds = 0;
+      /// Time spent in the optimization pipeline.
+      double optimize_seconds = 0;
+      /// Time spent generating and linking machine code.
+      double codegen_seconds = 0;
+      /// Size of the emitted machine code in bytes.
+      uint64_t code_size = 0;
+    };
+
+    explicit ParabixCompiler(llvm::orc::ThreadSafeContext& context, OptimizationLevel level = OptimizationLevel::O2)
       : context(context)
       , module(std::make_unique<llvm::Module>("parabix_module", *context.getContext()))
-      , jit(context)
+      , jit(context, level)
       , runFnPtr(nullptr) {}
 
-    void compile(const std::vector<parser::CC>& cc_list, bool verbose = false);
+    /// Compile the block function, `records` adds the record boundaries and the record hits.
+    /// The positions of the `delimiter` are record boundaries as well, a delimiter implies records.
+    void compile(const std::vector<parser::CC>& cc_list, bool verbose = false, bool records = false, const std::optional<parser::CC>& delimiter = std::nullopt);
+
+    /// Process a single block, returns true if the block had no active marker and was skipped.
+    /// The marker stream is not updated for skipped blocks.
+    /// The compiled function has no state of its own, concurrent calls with separate streams are safe.
+    ///
+    /// With records, the set bits of `boundary` and the delimiters separate the input into records. The character
+    /// classes never match at a boundary, so no match crosses it, and a marker at a boundary is a match at the end
+    /// of a record. cc[cc_size] receives all boundaries of the block, also if it is skipped. marker[cc_size + 1]
+    /// receives the boundaries whose record had a match, carry[cc_size] is the carry of this scan.
+    bool run(uint64_t* basis, uint64_t* cc, uint64_t* marker, uint64_t* carry, uint64_t boundary = 0) const;
 
-    void run(uint64_t* basis, uint64_t* cc, uint64_t* marker, uint64_t* carry);
+    /// Get the statistics of the last compilation.
+    [[nodiscard]] const CompileStatistics& getStatistics() const { return statistics; }
 
     private:
-    void compileRun(const std::vector<parser::CC>& cc_list);
+    void compileRun(const std::vector<parser::CC>& cc_list, bool records, const std::optional<parser::CC>& delimiter);
 
     /// The llvm context.
     llvm::orc::ThreadSafeContext& context;
@@ -40,7 +68,9 @@ namespace codegen {
     /// The jit.
     JIT jit;
     /// The compiled match function.
-    void (*runFnPtr)(uint64_t*, uint64_t*, uint64_t*, uint64_t*);
+    uint8_t (*runFnPtr)(uint64_t*, uint64_t*, uint64_t*, uint64_t*, uint64_t);
+    /// The compile statistics.
+    CompileStatistics statistics;
   };
 
 } // namespace codegen
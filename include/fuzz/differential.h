@@ -0,0 +1,81 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_FUZZ_DIFFERENTIAL_H_
+#define INCLUDE_FUZZ_DIFFERENTIAL_H_
+// ---------------------------------------------------------------------------
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "generator/input_generator.h"
+// ---------------------------------------------------------------------------
+namespace fuzz {
+// ---------------------------------------------------------------------------
+// A pattern and an input
+struct Case {
+  std::string pattern;
+  std::string input;
+};
+// ---------------------------------------------------------------------------
+/// Print the case as escaped C++ literals, ready to be pasted into a test.
+std::ostream& operator<<(std::ostream& os, const Case& c);
+// ---------------------------------------------------------------------------
+// The match count of a single engine
+struct Result {
+  std::string engine;
+  uint64_t matched;
+};
+// ---------------------------------------------------------------------------
+// Randomized differential tester of the engines.
+// Patterns are generated within the grammar of the ReParser, inputs are random or adversarial:
+// matches that straddle block boundaries, long star runs and lengths around multiples of 63.
+// The DFA is the reference, std::regex is an independent oracle for inputs up to `max_regex_length`.
+class Differential {
+  public:
+    struct Options {
+      /// Seed of the case generator.
+      uint64_t seed = 42;
+      /// Maximum input length.
+      size_t max_length = 1024;
+      /// Maximum number of character classes of a pattern.
+      size_t max_cc = 6;
+      /// Compare against std::regex for inputs up to this length, it is quadratic.
+      size_t max_regex_length = 256;
+      /// Include the JIT compiled engine.
+      bool llvm = true;
+    };
+
+    explicit Differential(Options options);
+
+    /// Generate the next case.
+    Case next();
+
+    /// Run all engines on the case.
+    std::vector<Result> run(const Case& c);
+
+    /// True if all engines agree on the case.
+    bool check(const Case& c);
+
+    /// Shrink a failing case to a small case that still fails.
+    Case shrink(Case c);
+
+    /// Count the match end positions with std::regex, one anchored search per end position.
+    static uint64_t regex_count(const Case& c);
+
+  private:
+    /// Generate a pattern of the ReParser grammar.
+    std::string next_pattern();
+
+    /// Generate an input for the pattern.
+    std::string next_input(const std::string& pattern);
+
+    Options options;
+    generator::Random random;
+    llvm::orc::ThreadSafeContext context;
+};
+// ---------------------------------------------------------------------------
+} // namespace fuzz
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_FUZZ_DIFFERENTIAL_H_
+// ---------------------------------------------------------------------------
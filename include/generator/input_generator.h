@@ -0,0 +1,109 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_GENERATOR_INPUT_GENERATOR_H_
+#define INCLUDE_GENERATOR_INPUT_GENERATOR_H_
+// ---------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "parser/cc.h"
+// ---------------------------------------------------------------------------
+namespace generator {
+// ---------------------------------------------------------------------------
+// Small and fast deterministic random number generator (SplitMix64)
+class Random {
+  public:
+    explicit Random(uint64_t seed)
+      : state(seed) {}
+
+    uint64_t next() {
+      uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    }
+
+    /// Uniform number in [0, n).
+    uint64_t uniform(uint64_t n) {
+      return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+
+    /// Bernoulli trial with the given probability.
+    bool chance(double probability) {
+      return static_cast<double>(next() >> 11) * 0x1.0p-53 < probability;
+    }
+
+  private:
+    uint64_t state;
+};
+// ---------------------------------------------------------------------------
+// Generates line oriented text for a pattern: every line is either an instance of the pattern
+// or a near miss, and no character class matches the line separator, so a match never spans lines.
+// The output only depends on the seed and the size, not on the number of threads.
+class InputGenerator {
+  public:
+    struct Options {
+      /// The pattern of the planted matches.
+      std::string pattern = "a[0-9]*z";
+      /// Fraction of lines that contain a match.
+      double selectivity = 0.1;
+      /// Seed of the generator.
+      uint64_t seed = 42;
+      /// Maximum number of repetitions of a star character class.
+      uint32_t max_repeat = 5;
+      /// Number of threads.
+      unsigned threads = 1;
+      /// Size of the independently seeded chunks, the unit of parallelism.
+      uint64_t chunk_size = 16ULL << 20;
+    };
+
+    explicit InputGenerator(Options options);
+
+    /// Output size for the requested size, rounded up to full 63 byte blocks.
+    [[nodiscard]] static uint64_t output_size(uint64_t size) { return (size + 62) / 63 * 63; }
+
+    /// Generate the input in memory.
+    std::string generate(uint64_t size);
+
+    /// Generate the input into a file with large positional writes.
+    void generate(uint64_t size, const char* path);
+
+    /// Number of planted matching lines of the last generation.
+    [[nodiscard]] uint64_t planted_matches() const { return planted; }
+
+    /// The line separator.
+    [[nodiscard]] char separator() const { return separator_; }
+
+  private:
+    /// Fill the chunk with the given index, returns the number of planted matches.
+    uint64_t fill_chunk(uint64_t index, char* output, uint64_t size) const;
+
+    /// Write a line that matches the pattern.
+    void write_match(Random& random, std::string& line) const;
+
+    /// Write a line that does not match the pattern, if there is one.
+    /// Returns true if every line matches and a matching line was written instead.
+    bool write_miss(Random& random, std::string& line) const;
+
+    /// Run the chunk generation on the worker threads.
+    template <typename Consumer>
+    void run(uint64_t size, Consumer&& consumer);
+
+    Options options;
+    std::vector<parser::CC> cc_list;
+    /// Characters of each character class.
+    std::vector<std::string> members;
+    /// Printable characters outside of each character class (and not the separator).
+    std::vector<std::string> non_members;
+    /// Positions of the non-star character classes that can be replaced by a non-member.
+    std::vector<size_t> breakable;
+    /// Upper bound of a line length including the separator.
+    uint64_t max_line;
+    char separator_;
+    uint64_t planted;
+};
+// ---------------------------------------------------------------------------
+} // namespace generator
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_GENERATOR_INPUT_GENERATOR_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_IO_READ_AHEAD_H_
+#define INCLUDE_IO_READ_AHEAD_H_
+// ---------------------------------------------------------------------------
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "io/source.h"
+#include "stream/aligned_allocator.h"
+// ---------------------------------------------------------------------------
+namespace io {
+// ---------------------------------------------------------------------------
+// Reads a source on its own thread into a bounded ring of buffers.
+// Reading, or decompressing, overlaps with the consumer, which only waits if the ring runs empty.
+// All buffers but the last are full and hold a multiple of the 63 byte blocks of the matcher.
+// Buffers are page aligned, so sources with direct I/O read straight into them.
+class ReadAhead {
+  public:
+    /// `buffer_size` is rounded down to a multiple of the block size and of the alignment of the source.
+    explicit ReadAhead(std::unique_ptr<Source> source, size_t buffer_size = 4 << 20, size_t buffers = 4);
+    ~ReadAhead();
+
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    /// The next buffer, empty at the end of the input. It stays valid until the next call.
+    /// Rethrows the errors of the reader thread.
+    std::string_view next();
+
+  private:
+    struct Slot {
+      std::vector<char, stream::AlignedAllocator<char, 4096>> data;
+      size_t size = 0;
+    };
+
+    /// The reader thread.
+    void produce();
+
+    std::unique_ptr<Source> source;
+    std::vector<Slot> slots;
+    std::mutex mutex;
+    std::condition_variable filled;
+    std::condition_variable emptied;
+    /// Number of filled slots that were not handed out yet.
+    size_t ready = 0;
+    /// Number of slots that are filled or held by the consumer.
+    size_t used = 0;
+    /// The slot that is handed out next.
+    size_t read_index = 0;
+    /// True if the consumer holds the slot before `read_index`.
+    bool holding = false;
+    /// True if the reader reached the end or failed.
+    bool done = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::thread thread;
+};
+// ---------------------------------------------------------------------------
+} // namespace io
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_IO_READ_AHEAD_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_IO_SOURCE_H_
+#define INCLUDE_IO_SOURCE_H_
+// ---------------------------------------------------------------------------
+#include <cstddef>
+#include <memory>
+#include <string>
+// ---------------------------------------------------------------------------
+namespace io {
+// ---------------------------------------------------------------------------
+// A sequential source of input bytes
+class Source {
+  public:
+    virtual ~Source() = default;
+
+    /// Read up to `size` bytes, returns the number of bytes read, 0 at the end of the input.
+    virtual size_t read(char* buffer, size_t size) = 0;
+
+    /// Required alignment of the buffer addresses and sizes, 1 if there is none.
+    [[nodiscard]] virtual size_t alignment() const { return 1; }
+};
+// ---------------------------------------------------------------------------
+// An uncompressed file
+class FileSource : public Source {
+  public:
+    explicit FileSource(const std::string& path);
+    ~FileSource() override;
+
+    size_t read(char* buffer, size_t size) override;
+
+  private:
+    int fd;
+};
+// ---------------------------------------------------------------------------
+// An uncompressed file read with O_DIRECT and pread, the reads bypass the page cache.
+// Falls back to buffered reads if the file system does not support direct I/O.
+class DirectFileSource : public Source {
+  public:
+    explicit DirectFileSource(const std::string& path);
+    ~DirectFileSource() override;
+
+    size_t read(char* buffer, size_t size) override;
+
+    [[nodiscard]] size_t alignment() const override { return ALIGNMENT; }
+
+    /// True if the reads bypass the page cache.
+    [[nodiscard]] bool direct() const { return direct_; }
+
+  private:
+    /// Logical block size of common devices, addresses, sizes and offsets are multiples of it.
+    static const size_t ALIGNMENT = 4096;
+
+    int fd;
+    bool direct_;
+    /// Offset of the next read.
+    size_t offset;
+};
+// ---------------------------------------------------------------------------
+// A gzip compressed file, decompressed with zlib
+class GzipSource : public Source {
+  public:
+    explicit GzipSource(const std::string& path);
+    ~GzipSource() override;
+
+    size_t read(char* buffer, size_t size) override;
+
+  private:
+    /// The zlib file handle, gzFile.
+    void* file;
+};
+// ---------------------------------------------------------------------------
+#if ZSTD
+// A zstd compressed file
+class ZstdSource : public Source {
+  public:
+    explicit ZstdSource(const std::string& path);
+    ~ZstdSource() override;
+
+    size_t read(char* buffer, size_t size) override;
+
+  private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+#endif
+// ---------------------------------------------------------------------------
+/// Open the file with the source that fits its magic bytes: gzip, zstd or plain.
+/// Plain files are read with direct I/O if `direct` is set.
+std::unique_ptr<Source> open(const std::string& path, bool direct = false);
+
+/// True if the magic bytes of the file belong to a supported compression format.
+bool is_compressed(const std::string& path);
+// ---------------------------------------------------------------------------
+} // namespace io
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_IO_SOURCE_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,309 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_OPERATIONS_LAZY_H_
+#define INCLUDE_OPERATIONS_LAZY_H_
+// ---------------------------------------------------------------------------
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <immintrin.h>
+
+#include "parser/cc.h"
+#include "stream/bit_stream.h"
+// ---------------------------------------------------------------------------
+// Lazy bit stream expressions.
+// An expression is evaluated tile by tile: every node computes the blocks of the current tile into its own small
+// buffer and keeps its carries for the next tile. A whole marker chain runs in a single pass over the input and
+// needs O(tile) memory per node instead of a full stream per character class and marker.
+// Tiles must be evaluated in order, starting with block 0.
+namespace operation::lazy {
+// ---------------------------------------------------------------------------
+/// Blocks per tile, 2 KB per node keeps the buffers of a chain in L1/L2.
+const size_t TILE_BLOCKS = 256;
+/// Bits per block, the most significant bit is always clear.
+const size_t BLOCK_BITS = 63;
+const uint64_t BLOCK_MASK = ~(1ULL << BLOCK_BITS);
+// ---------------------------------------------------------------------------
+/// Base of all expression nodes.
+struct Lazy {};
+
+template <typename E>
+using IsLazy = std::enable_if_t<std::is_base_of_v<Lazy, std::decay_t<E>>, int>;
+
+using Tile = std::array<uint64_t, TILE_BLOCKS>;
+// ---------------------------------------------------------------------------
+/// An existing bit stream.
+class Ref : public Lazy {
+  public:
+    explicit Ref(const stream::BitStream& stream)
+      : data(stream.data()) {}
+
+    const uint64_t* eval(size_t block, size_t) { return data + block; }
+
+  private:
+    const uint64_t* data;
+};
+// ---------------------------------------------------------------------------
+/// The character class bit stream of the input text, computed with AVX2 range compares.
+class Chars : public Lazy {
+  public:
+    Chars(const char* input, size_t size, const parser::CC& cc)
+      : input(input)
+      , size(size)
+      , ranges(cc.getRanges()) {}
+
+    const uint64_t* eval(size_t block, size_t count) {
+      alignas(32) std::array<char, 64> padded;
+      for (size_t i = 0; i < count; ++i) {
+        auto pos = (block + i) * BLOCK_BITS;
+        auto* data = input + pos;
+        // the last blocks are padded with zeros, so the loads never read behind the input
+        auto valid = pos < size ? std::min(BLOCK_BITS, size - pos) : 0;
+        if (pos + padded.size() > size) {
+          padded.fill(0);
+          std::memcpy(padded.data(), data, valid);
+          data = padded.data();
+        }
+        auto low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        auto high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+        auto word = (static_cast<uint64_t>(match(high)) << 32) | match(low);
+        tile[i] = word & (valid == BLOCK_BITS ? BLOCK_MASK : (1ULL << valid) - 1);
+      }
+      return tile.data();
+    }
+
+  private:
+    uint32_t match(__m256i chars) const {
+      // unsigned range check: low <= c <= high
+      auto result = _mm256_setzero_si256();
+      for (auto& [low, high] : ranges) {
+        auto above = _mm256_cmpeq_epi8(_mm256_max_epu8(chars, _mm256_set1_epi8(low)), chars);
+        auto below = _mm256_cmpeq_epi8(_mm256_min_epu8(chars, _mm256_set1_epi8(high)), chars);
+        result = _mm256_or_si256(result, _mm256_and_si256(above, below));
+      }
+      return static_cast<uint32_t>(_mm256_movemask_epi8(result));
+    }
+
+    const char* input;
+    size_t size;
+    std::vector<std::pair<char, char>> ranges;
+    alignas(64) Tile tile;
+};
+// ---------------------------------------------------------------------------
+/// Element wise operation of two expressions.
+template <typename Op, typename L, typename R>
+class Binary : public Lazy {
+  public:
+    Binary(L left, R right)
+      : left(std::move(left))
+      , right(std::move(right)) {}
+
+    const uint64_t* eval(size_t block, size_t count) {
+      auto* l = left.eval(block, count);
+      auto* r = right.eval(block, count);
+      for (size_t i = 0; i < count; ++i) {
+        tile[i] = Op::apply(l[i], r[i]);
+      }
+      return tile.data();
+    }
+
+  private:
+    L left;
+    R right;
+    alignas(64) Tile tile;
+};
+
+struct AndOp { static uint64_t apply(uint64_t a, uint64_t b) { return a & b; } };
+struct OrOp { static uint64_t apply(uint64_t a, uint64_t b) { return a | b; } };
+struct XorOp { static uint64_t apply(uint64_t a, uint64_t b) { return a ^ b; } };
+struct AndNotOp { static uint64_t apply(uint64_t a, uint64_t b) { return a & ~b; } };
+// ---------------------------------------------------------------------------
+template <typename E>
+class Not : public Lazy {
+  public:
+    explicit Not(E expression)
+      : expression(std::move(expression)) {}
+
+    const uint64_t* eval(size_t block, size_t count) {
+      auto* e = expression.eval(block, count);
+      for (size_t i = 0; i < count; ++i) {
+        tile[i] = e[i] ^ BLOCK_MASK;
+      }
+      return tile.data();
+    }
+
+  private:
+    E expression;
+    alignas(64) Tile tile;
+};
+// ---------------------------------------------------------------------------
+/// The marker operations, their carries are kept between the tiles.
+template <typename M, typename C>
+class Marker : public Lazy {
+  public:
+    Marker(M marker, C cc)
+      : marker(std::move(marker))
+      , cc(std::move(cc))
+      , carry(0) {}
+
+  protected:
+    M marker;
+    C cc;
+    uint64_t carry;
+    alignas(64) Tile tile;
+};
+
+/// (marker & cc) >> 1
+template <typename M, typename C>
+class Advance : public Marker<M, C> {
+  public:
+    using Marker<M, C>::Marker;
+
+    const uint64_t* eval(size_t block, size_t count) {
+      auto* m = this->marker.eval(block, count);
+      auto* c = this->cc.eval(block, count);
+      auto carry = this->carry;
+      for (size_t i = 0; i < count; ++i) {
+        auto shifted = ((m[i] & c[i]) << 1) | carry;
+        carry = shifted >> BLOCK_BITS;
+        this->tile[i] = shifted & BLOCK_MASK;
+      }
+      this->carry = carry;
+      return this->tile.data();
+    }
+};
+
+/// (((marker & cc) + cc) ^ cc) | marker
+template <typename M, typename C>
+class MatchStar : public Marker<M, C> {
+  public:
+    using Marker<M, C>::Marker;
+
+    const uint64_t* eval(size_t block, size_t count) {
+      auto* m = this->marker.eval(block, count);
+      auto* c = this->cc.eval(block, count);
+      auto* tile = this->tile.data();
+      for (size_t i = 0; i < count; ++i) {
+        tile[i] = m[i] & c[i];
+      }
+      this->carry = stream::add_blocks(tile, tile, c, count, this->carry);
+      for (size_t i = 0; i < count; ++i) {
+        tile[i] = (tile[i] ^ c[i]) | m[i];
+      }
+      return tile;
+    }
+};
+
+/// (marker + cc) & ~cc
+template <typename M, typename C>
+class ScanThru : public Marker<M, C> {
+  public:
+    using Marker<M, C>::Marker;
+
+    const uint64_t* eval(size_t block, size_t count) {
+      auto* m = this->marker.eval(block, count);
+      auto* c = this->cc.eval(block, count);
+      auto* tile = this->tile.data();
+      this->carry = stream::add_blocks(tile, m, c, count, this->carry);
+      for (size_t i = 0; i < count; ++i) {
+        tile[i] &= ~c[i];
+      }
+      return tile;
+    }
+};
+// ---------------------------------------------------------------------------
+/// Type erased expression, for chains that are built at runtime.
+/// The virtual call happens once per tile, not once per block.
+class Node : public Lazy {
+  public:
+    template <typename E, IsLazy<E> = 0>
+    explicit Node(E expression)
+      : impl(std::make_unique<Impl<E>>(std::move(expression))) {}
+
+    const uint64_t* eval(size_t block, size_t count) { return impl->eval(block, count); }
+
+  private:
+    struct Interface {
+      virtual ~Interface() = default;
+      virtual const uint64_t* eval(size_t block, size_t count) = 0;
+    };
+
+    template <typename E>
+    struct Impl : Interface {
+      explicit Impl(E expression)
+        : expression(std::move(expression)) {}
+      const uint64_t* eval(size_t block, size_t count) override { return expression.eval(block, count); }
+      E expression;
+    };
+
+    std::unique_ptr<Interface> impl;
+};
+// ---------------------------------------------------------------------------
+inline Ref ref(const stream::BitStream& stream) { return Ref(stream); }
+
+inline Chars chars(const char* input, size_t size, const parser::CC& cc) { return Chars(input, size, cc); }
+
+template <typename E, IsLazy<E> = 0>
+Node erase(E expression) { return Node(std::move(expression)); }
+
+template <typename L, typename R, IsLazy<L> = 0, IsLazy<R> = 0>
+Binary<AndOp, L, R> operator&(L left, R right) { return {std::move(left), std::move(right)}; }
+
+template <typename L, typename R, IsLazy<L> = 0, IsLazy<R> = 0>
+Binary<OrOp, L, R> operator|(L left, R right) { return {std::move(left), std::move(right)}; }
+
+template <typename L, typename R, IsLazy<L> = 0, IsLazy<R> = 0>
+Binary<XorOp, L, R> operator^(L left, R right) { return {std::move(left), std::move(right)}; }
+
+template <typename L, typename R, IsLazy<L> = 0, IsLazy<R> = 0>
+Binary<AndNotOp, L, R> and_not(L left, R right) { return {std::move(left), std::move(right)}; }
+
+template <typename E, IsLazy<E> = 0>
+Not<E> operator~(E expression) { return Not<E>(std::move(expression)); }
+
+template <typename M, typename C, IsLazy<M> = 0, IsLazy<C> = 0>
+Advance<M, C> advance(M marker, C cc) { return {std::move(marker), std::move(cc)}; }
+
+template <typename M, typename C, IsLazy<M> = 0, IsLazy<C> = 0>
+MatchStar<M, C> match_star(M marker, C cc) { return {std::move(marker), std::move(cc)}; }
+
+template <typename M, typename C, IsLazy<M> = 0, IsLazy<C> = 0>
+ScanThru<M, C> scan_thru(M marker, C cc) { return {std::move(marker), std::move(cc)}; }
+// ---------------------------------------------------------------------------
+/// Evaluate the expression over `blocks` blocks, the consumer receives (first block, tile, count).
+template <typename E, typename Consumer, IsLazy<E> = 0>
+void evaluate(E& expression, size_t blocks, Consumer&& consumer) {
+  for (size_t block = 0; block < blocks; block += TILE_BLOCKS) {
+    auto count = std::min(TILE_BLOCKS, blocks - block);
+    consumer(block, expression.eval(block, count), count);
+  }
+}
+
+/// Number of set bits of the expression.
+template <typename E, IsLazy<E> = 0>
+uint64_t pop_count(E& expression, size_t blocks) {
+  uint64_t result = 0;
+  evaluate(expression, blocks, [&](size_t, const uint64_t* tile, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      result += _mm_popcnt_u64(tile[i]);
+    }
+  });
+  return result;
+}
+
+/// Write the expression into the bit stream, its size determines the number of blocks.
+template <typename E, IsLazy<E> = 0>
+void materialize(E& expression, stream::BitStream& result) {
+  evaluate(expression, result.block_size(), [&](size_t block, const uint64_t* tile, size_t count) {
+    std::memcpy(result.data() + block, tile, count * sizeof(uint64_t));
+  });
+}
+// ---------------------------------------------------------------------------
+} // namespace operation::lazy
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_OPERATIONS_LAZY_H_
+// ---------------------------------------------------------------------------
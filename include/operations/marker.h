@@ -1,3 +1,4 @@
+#include <cassert>
 #include "stream/bit_stream.h"
 
 using BitStream = stream::BitStream;
@@ -6,29 +7,43 @@ namespace operation {
 
   namespace marker {
 
-    inline BitStream advance(const BitStream& marker, BitStream& cc) {
-      BitStream result = marker;
-      result &= cc;
+    /// Three operand forms, the result is written into `result` which may be one of the operands.
+    inline void advance(BitStream& result, const BitStream& marker, const BitStream& cc) {
+      result.assign_and(marker, cc);
       result >>= 1;
-      return result;
     }
 
-    inline BitStream match_star(const BitStream& marker, BitStream& cc) {
-      BitStream result = marker;
-      result &= cc;
+    inline void match_star(BitStream& result, const BitStream& marker, const BitStream& cc) {
+      // `marker` is needed at the end, so it must not be overwritten
+      assert(&result != &marker && "result must not be the marker");
+      result.assign_and(marker, cc);
       result += cc;
       result ^= cc;
       result |= marker;
+    }
+
+    inline void scan_thru(BitStream& result, const BitStream& marker, const BitStream& cc) {
+      result.assign_add(marker, cc);
+      result.assign_and_not(result, cc);
+    }
+
+    inline BitStream advance(const BitStream& marker, BitStream& cc) {
+      BitStream result;
+      advance(result, marker, cc);
       return result;
     }
 
-    inline BitStream scan_thru(const BitStream& marker, BitStream& cc) {
-      BitStream result = marker;
-      result += cc;
-      result &= ~cc;
+    inline BitStream match_star(const BitStream& marker, BitStream& cc) {
+      BitStream result;
+      match_star(result, marker, cc);
       return result;
     }
 
+    inline BitStream scan_thru(const BitStream& marker, BitStream& cc) {
+      BitStream result;
+      scan_thru(result, marker, cc);
+      return result;
+    }
 
   } // namespace marker
 
@@ -1,111 +1,105 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
-#include <iostream>
 #include <vector>
 #include <immintrin.h>
+#include <x86intrin.h>
 
 namespace operation {
 
+  // Marker operations on streams with one byte (0 or 1) per position.
+  // 64 positions are compressed into a bit mask with movemask, the arithmetic runs on the masks with the
+  // carry in a register (add with carry), and the result is expanded back into bytes.
   namespace simd {
 
-    inline std::vector<uint8_t> advance(const std::vector<uint8_t>& marker, const std::vector<uint8_t>& cc) {
-      assert(marker.size() == cc.size() && "sizes must be same");
-
-      auto size = cc.size();
-      auto simd_size = 32;
-      std::vector<uint8_t> result(size);
-      size_t near = size - (size % simd_size);
-
-      for (auto i = 0; i < near; i += simd_size) {
-        const __m256i* marker_ptr = reinterpret_cast<const __m256i*>(marker.data() + i);
-        const __m256i* cc_ptr = reinterpret_cast<const __m256i*>(cc.data() + i);
-        __m256i marker_i = _mm256_loadu_si256(marker_ptr);
-        __m256i cc_i = _mm256_loadu_si256(cc_ptr);
-
-        __m256i op1 = _mm256_and_si256(marker_i, cc_i);
-
-        __m256i* result_i = reinterpret_cast<__m256i*>(result.data() + i);
-        _mm256_storeu_si256(result_i, op1);
-      }
+    /// 64 positions to a bit mask, every non zero byte is set.
+    inline uint64_t to_mask(const uint8_t* bytes) {
+      auto zero = _mm256_setzero_si256();
+      auto low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes)), zero);
+      auto high = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + 32)), zero);
+      auto zeros = (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32) |
+                   static_cast<uint32_t>(_mm256_movemask_epi8(low));
+      return ~zeros;
+    }
 
-      for (auto i = near; i < size; ++i) {
-        result[i] = marker[i] & cc[i];
+    /// Bit mask to 64 positions of 0 or 1.
+    inline void from_mask(uint64_t mask, uint8_t* bytes) {
+      // byte i of the output selects byte i / 8 of the (32 bit) mask, shuffles stay within 128 bit lanes
+      const auto select = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                           2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+      const auto bits = _mm256_set1_epi64x(static_cast<int64_t>(0x8040201008040201ULL));
+      const auto one = _mm256_set1_epi8(1);
+      for (auto half = 0; half < 2; ++half) {
+        auto part = _mm256_set1_epi32(static_cast<int32_t>(mask >> (32 * half)));
+        auto selected = _mm256_and_si256(_mm256_shuffle_epi8(part, select), bits);
+        auto set = _mm256_and_si256(_mm256_cmpeq_epi8(selected, bits), one);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + 32 * half), set);
       }
-
-      memmove(result.data() + 1, result.data(), size - 1);
-      auto carry = result[size - 1] == 1;
-      result[0] = 0;
-
-      return result;
     }
 
-    inline std::vector<uint8_t> match_star(const std::vector<uint8_t>& marker, const std::vector<uint8_t>& cc) {
-      assert(marker.size() == cc.size() && "sizes must be same");
-
-      auto size = cc.size();
-      auto simd_size = 32; // 256 / 8
-      std::vector<uint8_t> result(size);
-      size_t near = size - (size % simd_size);
-
-      for (auto i = 0; i < near; i += simd_size) {
-        const __m256i* marker_ptr = reinterpret_cast<const __m256i*>(marker.data() + i);
-        const __m256i* cc_ptr = reinterpret_cast<const __m256i*>(cc.data() + i);
-        __m256i marker_i = _mm256_loadu_si256(marker_ptr);
-        __m256i cc_i = _mm256_loadu_si256(cc_ptr);
-
-        // 1. AND
-        __m256i op1 = _mm256_and_si256(marker_i, cc_i);
-
-        __m256i* result_i = reinterpret_cast<__m256i*>(result.data() + i);
-        _mm256_storeu_si256(result_i, op1);
+    /// Apply `word(marker, cc, carry)` to all groups of 64 positions, returns the carry behind the last position.
+    /// The last partial group is processed in zero padded buffers.
+    template <typename Word>
+    inline uint64_t for_each_word(uint8_t* result, const uint8_t* marker, const uint8_t* cc, size_t size, uint64_t carry, Word&& word) {
+      size_t i = 0;
+      for (; i + 64 <= size; i += 64) {
+        from_mask(word(to_mask(marker + i), to_mask(cc + i), carry), result + i);
       }
-
-      for (auto i = near; i < size; ++i) {
-        result[i] = marker[i] & cc[i];
+      if (i < size) {
+        auto tail = size - i;
+        uint8_t marker_tail[64] = {}, cc_tail[64] = {}, result_tail[64];
+        std::memcpy(marker_tail, marker + i, tail);
+        std::memcpy(cc_tail, cc + i, tail);
+        // the carry out of the word is behind position 63, the carry of the stream is behind its last position
+        auto value = word(to_mask(marker_tail), to_mask(cc_tail), carry);
+        carry = (value >> tail) & 1;
+        from_mask(value, result_tail);
+        std::memcpy(result + i, result_tail, tail);
       }
+      return carry;
+    }
 
-      std::vector<uint8_t> carry(size, 0);
-      for (auto i = 0; i < size; ++i) {
-        auto op1 = result[i];
-
-        // 2. ADD
-        auto op2 = ((op1 ^ cc[i]) ^ carry[i]);
-        carry[i + 1] = ((op1 & cc[i]) | (op1 & carry[i])) | (cc[i] & carry[i]); 
-
-        result[i] = op2;
+    /// (marker & cc) >> 1 on a chunk of the stream, returns the carry into the next chunk.
+    /// A shift by one byte needs no masks: unaligned loads one position behind, from back to front so the result may alias.
+    inline uint64_t advance(uint8_t* result, const uint8_t* marker, const uint8_t* cc, size_t size, uint64_t carry = 0) {
+      if (size == 0) {
+        return carry;
       }
-
-      for (auto i = 0; i < near; i += simd_size) {
-        const __m256i* marker_ptr = reinterpret_cast<const __m256i*>(marker.data() + i);
-        const __m256i* cc_ptr = reinterpret_cast<const __m256i*>(cc.data() + i);
-        __m256i marker_i = _mm256_loadu_si256(marker_ptr);
-        __m256i cc_i = _mm256_loadu_si256(cc_ptr);
-
-        __m256i* result_i = reinterpret_cast<__m256i*>(result.data() + i);
-        __m256i op2 = _mm256_loadu_si256(result_i);
-
-        // 3. XOR
-        __m256i op3 = _mm256_xor_si256(op2, cc_i);
-
-        // 4. OR
-        __m256i op4 = _mm256_or_si256(op3, marker_i);
-
-        _mm256_storeu_si256(result_i, op4);
+      auto next_carry = static_cast<uint64_t>(marker[size - 1] & cc[size - 1]);
+      auto i = size;
+      for (; i >= 33; i -= 32) {
+        auto m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(marker + i - 33));
+        auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cc + i - 33));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i - 32), _mm256_and_si256(m, c));
       }
+      for (; i > 1; --i) {
+        result[i - 1] = marker[i - 2] & cc[i - 2];
+      }
+      result[0] = static_cast<uint8_t>(carry);
+      return next_carry;
+    }
 
-      for (auto i = near; i < size; ++i) {
-        auto op2 = result[i];
-
-        // 3. XOR
-        auto op3 = op2 ^ cc[i];
-
-        // 4. OR
-        auto op4 = op3 | marker[i];
+    /// (((marker & cc) + cc) ^ cc) | marker on a chunk of the stream, returns the carry into the next chunk.
+    inline uint64_t match_star(uint8_t* result, const uint8_t* marker, const uint8_t* cc, size_t size, uint64_t carry = 0) {
+      return for_each_word(result, marker, cc, size, carry, [](uint64_t m, uint64_t c, uint64_t& carry) {
+        unsigned long long sum;  // NOLINT
+        carry = _addcarry_u64(static_cast<unsigned char>(carry), m & c, c, &sum);
+        return (sum ^ c) | m;
+      });
+    }
 
-        result[i] = op4;
-      }
+    inline std::vector<uint8_t> advance(const std::vector<uint8_t>& marker, const std::vector<uint8_t>& cc) {
+      assert(marker.size() == cc.size() && "sizes must be same");
+      std::vector<uint8_t> result(cc.size());
+      advance(result.data(), marker.data(), cc.data(), cc.size());
+      return result;
+    }
 
+    inline std::vector<uint8_t> match_star(const std::vector<uint8_t>& marker, const std::vector<uint8_t>& cc) {
+      assert(marker.size() == cc.size() && "sizes must be same");
+      std::vector<uint8_t> result(cc.size());
+      match_star(result.data(), marker.data(), cc.data(), cc.size());
       return result;
     }
 
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <emmintrin.h>
 
 namespace parabix {
@@ -19,4 +22,27 @@ namespace parabix {
     }
   }
 
+  /// Transpose the 63 byte blocks [first_block, first_block + count) of the input into basis bit streams.
+  /// Blocks at the end of the input are padded with zeros, so the 64 byte loads never read behind the input.
+  inline void transpose_blocks(const char* input, size_t input_size, size_t first_block, size_t count, std::array<uint64_t, 8>* basis) {
+    const size_t block_size = 63;
+    std::array<uint8_t, 64> output{};
+    std::array<char, 64> padded;
+    for (size_t c = 0; c < count; ++c) {
+      auto pos = (first_block + c) * block_size;
+      auto* data = const_cast<char*>(input) + pos;
+      if (pos + padded.size() > input_size) {
+        padded.fill(0);
+        std::memcpy(padded.data(), data, pos < input_size ? std::min(block_size, input_size - pos) : 0);
+        data = padded.data();
+      }
+      transpose_sse(data, output.data());
+
+      for (auto k = 0, j = 7; k < 8; ++k, --j) {
+        basis[c][k] = *reinterpret_cast<uint64_t*>(&output[static_cast<unsigned>(j * 8)]);
+        basis[c][k] &= ~(1ULL << block_size);
+      }
+    }
+  }
+
 } // namespace parabix
@@ -0,0 +1,53 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_CSV_H_
+#define INCLUDE_PARABIX_CSV_H_
+// ---------------------------------------------------------------------------
+#include <array>
+#include <cstdint>
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+/// Positions of the character in a block of transposed basis bits.
+inline uint64_t match_char(const std::array<uint64_t, 8>& basis, char c) {
+  auto result = ~(1ULL << 63);
+  for (auto bit = 0; bit < 8; ++bit) {
+    result &= (static_cast<uint8_t>(c) >> bit) & 1 ? basis[bit] : ~basis[bit];
+  }
+  return result;
+}
+// ---------------------------------------------------------------------------
+// The positions of a single field of CSV rows, computed block by block from the basis bits.
+// Quoted regions are the prefix XOR of the quote stream, separators inside quotes are part of the field.
+// Blocks must be processed in order, the quote parity and the field index carry over to the next block.
+class CsvFields {
+  public:
+    struct Options {
+      /// Field separator.
+      char separator = ',';
+      /// Quote character, separators between quotes do not end a field.
+      char quote = '"';
+    };
+
+    /// Select the field with the (zero based) index.
+    CsvFields(unsigned field, Options options);
+
+    /// The positions of the selected field in the next block, without the separators.
+    uint64_t next(const std::array<uint64_t, 8>& basis);
+
+    /// The unquoted newlines of the last block, they end the rows.
+    [[nodiscard]] uint64_t newlines() const { return newlines_; }
+
+  private:
+    unsigned field;
+    Options options;
+    /// All ones if the last block ended inside quotes.
+    uint64_t inside_quotes;
+    /// The field index at the end of the last block.
+    unsigned current;
+    uint64_t newlines_;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_CSV_H_
+// ---------------------------------------------------------------------------
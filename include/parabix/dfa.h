@@ -0,0 +1,57 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_DFA_H_
+#define INCLUDE_PARABIX_DFA_H_
+// ---------------------------------------------------------------------------
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "parser/cc.h"
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// Lazily built table DFA over the character class sequence.
+// It counts match end positions exactly like the marker streams of the bit stream engines,
+// a state is the set of markers that are active in front of the next character.
+class DFA {
+  public:
+    explicit DFA(std::vector<parser::CC> cc_list);
+
+    /// Count the match end positions in the input.
+    uint64_t match(const char* input, size_t size);
+
+    /// Number of states that were materialized so far.
+    [[nodiscard]] size_t state_count() const { return states.size(); }
+
+  private:
+    using StateSet = uint64_t;
+
+    static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    /// Close the set over the star operations that do not consume a character.
+    [[nodiscard]] StateSet closure(StateSet set) const;
+
+    /// Compute the transition of the state for the character, returns (next << 1) | accept.
+    uint32_t transition(uint32_t state, uint8_t c);
+
+    uint32_t intern(StateSet set);
+
+    /// The character classes.
+    std::vector<parser::CC> cc_list;
+    /// Bit i is set if the i-th character class matches the character.
+    std::array<uint64_t, 256> char_masks;
+    /// Bit i is set if the i-th character class is a star.
+    uint64_t star_mask;
+    /// The marker set of each state.
+    std::vector<StateSet> states;
+    /// The transition table, states x 256 entries of (next << 1) | accept.
+    std::vector<uint32_t> table;
+    /// The state of each marker set.
+    std::unordered_map<StateSet, uint32_t> state_ids;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_DFA_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,59 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_INTERPRETER_H_
+#define INCLUDE_PARABIX_INTERPRETER_H_
+// ---------------------------------------------------------------------------
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "codegen/bytecode_compiler.h"
+#include "parser/cc.h"
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// The block function of the bit stream kernel, interpreted without a JIT.
+// The character classes are compiled into a flat bytecode that evaluates a batch of blocks per instruction,
+// only the marker streams are computed block by block.
+// The carries have the layout of the JIT compiled kernel, one 0 or 1 per character class,
+// so a scan can move over to the compiled kernel at any block boundary.
+class Interpreter {
+  public:
+    explicit Interpreter(std::vector<parser::CC> cc_list);
+
+    /// Process a single block, returns true if the block had no active marker and was skipped.
+    /// The marker streams are not updated for skipped blocks.
+    bool run(const std::array<uint64_t, 8>& basis);
+
+    /// Process the blocks, returns the number of match end positions.
+    /// `skipped` is increased by the number of blocks without an active marker.
+    uint64_t run(const std::array<uint64_t, 8>* basis, size_t blocks, uint64_t& skipped);
+
+    /// Get the character class streams of the last block.
+    [[nodiscard]] const std::vector<uint64_t>& getCC() const { return cc; }
+    /// Get the marker streams of the last block, the last one holds the match end positions.
+    [[nodiscard]] const std::vector<uint64_t>& getMarkers() const { return marker; }
+    /// Get the carries into the next block.
+    [[nodiscard]] const std::vector<uint64_t>& getCarries() const { return carry; }
+
+  private:
+    /// Evaluate the character classes of up to a batch of blocks.
+    void evaluate(const std::array<uint64_t, 8>* basis, size_t blocks);
+
+    /// Compute the markers of a block of the evaluated batch, returns true if the block was skipped.
+    bool step(size_t block);
+
+    /// The character classes.
+    std::vector<parser::CC> cc_list;
+    /// The expressions of the character classes.
+    codegen::Bytecode bytecode;
+    /// The registers of the bytecode, a batch of words each.
+    std::vector<uint64_t> registers;
+    std::vector<uint64_t> cc;
+    std::vector<uint64_t> marker;
+    std::vector<uint64_t> carry;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_INTERPRETER_H_
+// ---------------------------------------------------------------------------
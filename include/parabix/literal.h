@@ -0,0 +1,18 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_LITERAL_H_
+#define INCLUDE_PARABIX_LITERAL_H_
+// ---------------------------------------------------------------------------
+#include <cstdint>
+#include <string_view>
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+/// Count the occurrences of a non-empty literal, overlapping ones included, like the match end positions of the
+/// other engines. The first and the last character are compared at 32 positions at once, and only the candidates
+/// are compared in full.
+uint64_t literal_count(const char* input, size_t size, std::string_view literal);
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_LITERAL_H_
+// ---------------------------------------------------------------------------
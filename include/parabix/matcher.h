@@ -0,0 +1,187 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_MATCHER_H_
+#define INCLUDE_PARABIX_MATCHER_H_
+// ---------------------------------------------------------------------------
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include "codegen/jit.h"
+#include "parabix/csv.h"
+#include "parabix/span.h"
+#include "parabix/stats.h"
+#include "parabix/thread_pool.h"
+#include "parser/cc.h"
+// ---------------------------------------------------------------------------
+namespace codegen {
+class ParabixCompiler;
+} // namespace codegen
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// A pattern compiled once with the LLVM backend.
+// The matcher is immutable after construction, any number of threads may call match concurrently.
+// The carries and markers of a call live in a Scratch, which is owned by the caller or thread local.
+class Matcher {
+  public:
+    struct Options {
+      /// Optimization level of the IR pipeline and the code generator.
+      codegen::OptimizationLevel level = codegen::OptimizationLevel::O2;
+      /// Print the generated IR.
+      bool verbose = false;
+      /// Compile the record boundaries into the kernel, required by match_column and match_field.
+      bool records = false;
+      /// Records end at this character, required by match_records and implies records.
+      std::optional<char> delimiter;
+    };
+
+    /// The records of a delimited input that contain a match.
+    struct Records {
+      /// Number of records, the last record may miss its delimiter.
+      uint64_t count = 0;
+      /// Number of records with at least one match.
+      uint64_t matched = 0;
+      /// Bit i % 8 of byte i / 8 is set if record i has a match.
+      std::vector<uint8_t> bitmap;
+    };
+
+    /// The first match end positions of an input.
+    struct First {
+      /// Number of match end positions found, at most the limit.
+      uint64_t matched = 0;
+      /// Offset behind the last match that was counted, or the input size if the limit was not reached.
+      /// A limit of 0 is reached at offset 0.
+      size_t offset = 0;
+    };
+
+    /// Per-call state of a scan, a scratch must not be used by two calls at the same time.
+    class Scratch {
+      friend class Matcher;
+
+      std::vector<uint64_t> cc;
+      std::vector<uint64_t> marker;
+      std::vector<uint64_t> carry;
+      std::vector<std::array<uint64_t, 8>> chunk;
+      /// The rows of a column, packed with a separator position behind every row.
+      std::vector<char> packed;
+      /// The separator positions of the packed rows.
+      std::vector<uint64_t> boundary;
+      /// The bytes of a stream behind its last full block.
+      std::array<char, 63> pending;
+      size_t pending_size = 0;
+      /// The stream offset of the next block.
+      uint64_t position = 0;
+    };
+
+    /// Compile the pattern in its own llvm context.
+    explicit Matcher(const std::string& pattern);
+    Matcher(const std::string& pattern, Options options);
+    /// Compile the pattern in the given llvm context.
+    Matcher(llvm::orc::ThreadSafeContext context, const std::string& pattern, Options options);
+
+    Matcher(Matcher&&) noexcept;
+    Matcher& operator=(Matcher&&) noexcept;
+    ~Matcher();
+
+    /// Count the match end positions in the input, uses a thread local scratch.
+    uint64_t match(const char* input, size_t size, Stats* stats = nullptr) const;
+    /// Count the match end positions in the input with the given scratch.
+    uint64_t match(Scratch& scratch, const char* input, size_t size, Stats* stats = nullptr) const;
+
+    /// Find the first `limit` match end positions and stop, for existence checks and the first N matches.
+    /// The scan stops in the block of the last counted match, so it is proportional to the distance to that match.
+    First match_first(const char* input, size_t size, uint64_t limit = 1, Stats* stats = nullptr) const;
+    First match_first(Scratch& scratch, const char* input, size_t size, uint64_t limit = 1, Stats* stats = nullptr) const;
+
+    /// Find the leftmost-longest matches that do not overlap, for the matched text itself.
+    /// The kernel finds the ends in a single pass, each end is then resolved to its start by a reverse walk
+    /// that stops with the last marker. Patterns of more than 63 character classes are not supported.
+    std::vector<Span> match_spans(const char* input, size_t size) const;
+    std::vector<Span> match_spans(Scratch& scratch, const char* input, size_t size) const;
+
+    /// Count the match end positions with the threads of the pool, for large inputs.
+    /// The input is split into segments of whole blocks that are matched independently with zero carries.
+    /// A serial pass then reruns the start of each segment with the carries of the segment in front of it,
+    /// until both runs reach the same carries. This is usually after a few blocks.
+    uint64_t match_parallel(const char* input, size_t size, ThreadPool& pool) const;
+
+    /// Start a stream in the scratch, the carries continue from one part of the stream to the next.
+    void start(Scratch& scratch) const;
+    /// Start a stream that continues the scan of another engine, with one carry of 0 or 1 per character class.
+    void start(Scratch& scratch, const std::vector<uint64_t>& carry) const;
+    /// Match the next part of the stream, returns the number of match end positions that were resolved.
+    /// Parts of any size are accepted, the bytes behind the last full block wait in the scratch for the next part.
+    /// The resolved positions are appended to `ends` if given, as offsets in the stream.
+    uint64_t feed(Scratch& scratch, const char* input, size_t size, Stats* stats = nullptr, std::vector<uint64_t>* ends = nullptr) const;
+    /// End the stream, returns the match end positions in the waiting bytes and behind the last character.
+    uint64_t finish(Scratch& scratch, Stats* stats = nullptr, std::vector<uint64_t>* ends = nullptr) const;
+    /// The stream offset behind the matched blocks if no marker carries over into the next block.
+    /// All matches that end later also start there or later, the stream in front of it can be released.
+    [[nodiscard]] std::optional<uint64_t> settled(const Scratch& scratch) const;
+
+    /// Match every row of a string column in Arrow layout, row i is data[offsets[i], offsets[i + 1]).
+    /// Returns the validity bitmap of the rows with at least one match, bit i % 8 of byte i / 8 is row i.
+    /// All rows share a single stream of blocks, a separator position behind every row stops the matches.
+    std::vector<uint8_t> match_column(const int32_t* offsets, size_t rows, const char* data) const;
+    std::vector<uint8_t> match_column(const int64_t* offsets, size_t rows, const char* data) const;
+    std::vector<uint8_t> match_column(Scratch& scratch, const int32_t* offsets, size_t rows, const char* data) const;
+    std::vector<uint8_t> match_column(Scratch& scratch, const int64_t* offsets, size_t rows, const char* data) const;
+
+    /// Select the records of the input that contain a match, in a single pass.
+    /// Records end at the delimiter of the options, matches never span two records.
+    Records match_records(const char* input, size_t size, Stats* stats = nullptr) const;
+    Records match_records(Scratch& scratch, const char* input, size_t size, Stats* stats = nullptr) const;
+
+    /// Select the CSV rows whose field with the (zero based) index contains a match, in a single pass.
+    /// Matches never leave the field, quoted separators and newlines are part of the field.
+    Records match_field(const char* input, size_t size, unsigned field, CsvFields::Options options = {}, Stats* stats = nullptr) const;
+    Records match_field(Scratch& scratch, const char* input, size_t size, unsigned field, CsvFields::Options options = {}, Stats* stats = nullptr) const;
+
+    /// Get the compiled pattern.
+    [[nodiscard]] const std::string& getPattern() const { return pattern; }
+    /// Get the span finder of the pattern, throws if the pattern is too long.
+    [[nodiscard]] const SpanFinder& getSpanFinder() const;
+    /// Get the parse and compile times, the scan fields are zero.
+    [[nodiscard]] const Stats& getStatistics() const { return statistics; }
+
+  private:
+    /// Pack the rows into the scratch and match them.
+    template <typename Offset>
+    std::vector<uint8_t> match_rows(Scratch& scratch, const Offset* offsets, size_t rows, const char* data) const;
+
+    /// Reset the carries and markers of the scratch.
+    void reset(Scratch& scratch) const;
+
+    /// Count the match end positions in the first `blocks` blocks of the input.
+    /// The positions are appended to `ends` if given, relative to the input.
+    uint64_t run_blocks(Scratch& scratch, const char* input, size_t size, size_t blocks, Stats& stats, std::vector<uint64_t>* ends = nullptr) const;
+
+    /// The source pattern, kept for the telemetry records.
+    std::string pattern;
+    /// The character classes of the pattern.
+    std::vector<parser::CC> cc_list;
+    /// The llvm context, on the heap so the compiler's reference survives a move.
+    std::unique_ptr<llvm::orc::ThreadSafeContext> context;
+    /// True if the kernel was compiled with record boundaries.
+    bool records;
+    /// The record delimiter of the kernel.
+    std::optional<char> delimiter;
+    /// Run the blocks of a stream and move the stream offset of the scratch behind them.
+    uint64_t run_stream(Scratch& scratch, const char* input, size_t size, size_t blocks, Stats& stats, std::vector<uint64_t>* ends) const;
+
+    /// Resolves the match ends to spans, empty for patterns that are too long.
+    std::optional<SpanFinder> spans;
+    /// The compiled block function.
+    std::unique_ptr<codegen::ParabixCompiler> compiler;
+    /// The compile statistics.
+    Stats statistics;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_MATCHER_H_
+// ---------------------------------------------------------------------------
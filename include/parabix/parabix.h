@@ -1,11 +1,23 @@
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <cinttypes>
 #include <string>
+#include "codegen/jit.h"
+#include "parabix/stats.h"
 
 namespace parabix {
 
-  uint64_t parabix_cpp(std::string& input, const char* pattern);
+  uint64_t parabix_cpp(std::string& input, const char* pattern, Stats* stats = nullptr);
 
-  uint64_t parabix_llvm(llvm::orc::ThreadSafeContext& context, std::string& input, const char* pattern, bool verbose = false);
+  /// Unblocked reference on whole-input bit streams, slow but simple.
+  uint64_t parabix_bit_stream(std::string& input, const char* pattern);
+
+  /// The BitStream path fused into a single pass over cache sized tiles of the input.
+  uint64_t parabix_fused(std::string& input, const char* pattern);
+
+  uint64_t parabix_llvm(llvm::orc::ThreadSafeContext& context, std::string& input, const char* pattern, bool verbose = false, codegen::OptimizationLevel level = codegen::OptimizationLevel::O2, Stats* stats = nullptr);
+
+  /// Choose the engine with the planner and count with it, the chosen engine is recorded in the stats.
+  /// The level applies when the planner chooses the JIT.
+  uint64_t parabix_planned(llvm::orc::ThreadSafeContext& context, std::string& input, const char* pattern, codegen::OptimizationLevel level = codegen::OptimizationLevel::O2, Stats* stats = nullptr);
 
 } // namespace parabix
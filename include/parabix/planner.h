@@ -0,0 +1,49 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_PLANNER_H_
+#define INCLUDE_PARABIX_PLANNER_H_
+// ---------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "parser/cc.h"
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+/// The engines that count match end positions.
+enum class Engine {
+  /// SIMD search of a pattern without ranges and stars.
+  Literal,
+  /// The lazily built table DFA.
+  DFA,
+  /// The bit stream kernel interpreted by parabix_cpp.
+  Interpreter,
+  /// The JIT compiled bit stream kernel.
+  JIT,
+};
+
+/// Name of the engine, for the stats and the benchmark.
+const char* engine_name(Engine engine);
+// ---------------------------------------------------------------------------
+// The engine chosen for a pattern and an input size
+struct Plan {
+  Engine engine = Engine::JIT;
+  /// The characters of a literal pattern.
+  std::string literal;
+  /// Number of and, or and not operations of the character class expressions.
+  size_t operations = 0;
+  /// Estimated seconds of the chosen engine, compilation included.
+  double estimated_seconds = 0;
+};
+// ---------------------------------------------------------------------------
+/// Choose the cheapest engine for the character classes and the input size.
+/// The literal search, the DFA, the interpreter and the JIT kernel are estimated if they can run the pattern,
+/// each with a fixed cost, such as the compilation of the JIT kernel, plus a cost per byte that grows with
+/// the operations of the character classes. The JIT kernel thus wins on large inputs. The DFA is left out
+/// for long patterns, whose states could explode.
+Plan plan(const std::vector<parser::CC>& cc_list, size_t input_size);
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_PLANNER_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,74 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_REPLACE_H_
+#define INCLUDE_PARABIX_REPLACE_H_
+// ---------------------------------------------------------------------------
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parabix/matcher.h"
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// Streaming substitution of the leftmost-longest matches.
+// The bytes of the stream are kept from the first byte that was not written yet. Once the kernel reports that no
+// marker carries over into the next block, everything in front of it is written, so only open matches are held back.
+// The output of a part is handed to the writer as a list of pieces, the unmatched regions point into the buffer.
+class Replacer {
+  public:
+    /// Receives the pieces of the output, they are valid until the writer returns.
+    using Writer = std::function<void(const std::vector<std::string_view>&)>;
+
+    /// An `&` in the replacement stands for the matched text, `\&` and `\\` for the characters themselves.
+    Replacer(const Matcher& matcher, const std::string& replacement, Writer writer);
+
+    /// Replace the matches in the next part of the stream, returns the number of replaced matches so far.
+    uint64_t feed(const char* input, size_t size);
+    /// End the stream and write the rest, returns the number of replaced matches.
+    uint64_t finish();
+
+  private:
+    struct Piece {
+      std::string text;
+      /// True if the piece stands for the matched text.
+      bool match;
+    };
+
+    /// Replace the matches whose end is known and write everything in front of `limit`.
+    void resolve(bool final, uint64_t limit);
+
+    /// The piece of the buffer at the stream offsets.
+    [[nodiscard]] std::string_view view(uint64_t begin, uint64_t end) const {
+      return std::string_view(buffer).substr(begin - buffer_begin, end - begin);
+    }
+
+    const Matcher& matcher;
+    /// The span finder of the matcher, the constructor throws for patterns without one.
+    const SpanFinder& finder;
+    Matcher::Scratch scratch;
+    std::vector<Piece> replacement;
+    Writer writer;
+    /// The stream bytes from `buffer_begin` on.
+    std::string buffer;
+    uint64_t buffer_begin = 0;
+    /// The first byte that was not written yet.
+    uint64_t written = 0;
+    /// The first position at which the next match may start.
+    uint64_t search = 0;
+    /// The match ends that were not resolved yet.
+    std::vector<uint64_t> ends;
+    size_t next_end = 0;
+    std::vector<std::string_view> pieces;
+    uint64_t replaced = 0;
+};
+// ---------------------------------------------------------------------------
+/// Replace the leftmost-longest matches of the whole input.
+std::string replace(const Matcher& matcher, const char* input, size_t size, const std::string& replacement);
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_REPLACE_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,59 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_SPAN_H_
+#define INCLUDE_PARABIX_SPAN_H_
+// ---------------------------------------------------------------------------
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "parser/cc.h"
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+/// A match, input[begin, end).
+struct Span {
+  size_t begin;
+  size_t end;
+
+  bool operator==(const Span& other) const { return begin == other.begin && end == other.end; }
+};
+// ---------------------------------------------------------------------------
+// Resolves the match end positions of the bit stream kernel to spans.
+// The reversed character class sequence runs backwards from an end to the leftmost start, the forward sequence
+// then runs from that start to the longest end. Both walks stop as soon as no marker is left, so the cost grows
+// with the length of the matches and not with the input. The markers are bits, bit i is set if the first i
+// character classes were matched, or for the reverse walk, if the classes from i on were matched.
+class SpanFinder {
+  public:
+    explicit SpanFinder(std::vector<parser::CC> cc_list);
+
+    /// Select the leftmost-longest matches that do not overlap, `ends` are the ascending match end positions.
+    /// A match starts at the leftmost start of the next free end and extends to its longest end.
+    [[nodiscard]] std::vector<Span> select(const char* input, size_t size, const std::vector<uint64_t>& ends) const;
+
+    /// The leftmost start at or behind `begin` of a match that ends at `end`.
+    [[nodiscard]] std::optional<size_t> leftmost_start(const char* input, size_t size, size_t end, size_t begin) const;
+
+    /// The longest end of a match that starts at `start`.
+    /// `incomplete` is set if the match could continue behind the input, for streams that are not finished yet.
+    [[nodiscard]] std::optional<size_t> longest_end(const char* input, size_t size, size_t start, bool* incomplete = nullptr) const;
+
+  private:
+    /// The character class bits of the character at the position, the blocks are padded with zeros.
+    [[nodiscard]] uint64_t char_mask(const char* input, size_t size, size_t pos) const {
+      return char_masks[pos < size ? static_cast<uint8_t>(input[pos]) : 0];
+    }
+
+    /// Number of character classes.
+    size_t cc_size;
+    /// Bit i is set if the i-th character class matches the character.
+    std::array<uint64_t, 256> char_masks;
+    /// Bit i is set if the i-th character class is a star.
+    uint64_t star_mask;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_SPAN_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_STATS_H_
+#define INCLUDE_PARABIX_STATS_H_
+// ---------------------------------------------------------------------------
+#include <chrono> // NOLINT
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// Wall clock timer for a single phase
+class Timer {
+  public:
+    Timer()
+      : start(std::chrono::steady_clock::now()) {}
+
+    /// Seconds since construction or the last reset.
+    [[nodiscard]] double elapsed() const {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// Seconds since construction or the last reset, restarts the timer.
+    double reset() {
+      auto now = std::chrono::steady_clock::now();
+      auto seconds = std::chrono::duration<double>(now - start).count();
+      start = now;
+      return seconds;
+    }
+
+  private:
+    std::chrono::steady_clock::time_point start;
+};
+// ---------------------------------------------------------------------------
+// Per-phase statistics of a single matching call
+struct Stats {
+  /// Time spent in ReParser::parse.
+  double parse_seconds = 0;
+  /// Time spent in CCCompiler::compile.
+  double cc_compile_seconds = 0;
+  /// Time spent building the LLVM IR.
+  double ir_build_seconds = 0;
+  /// Time spent in the LLVM optimization pipeline.
+  double optimize_seconds = 0;
+  /// Time spent generating and linking machine code.
+  double codegen_seconds = 0;
+  /// Time spent transposing the input into basis bit streams.
+  double transpose_seconds = 0;
+  /// Time spent evaluating the character classes and markers.
+  double kernel_seconds = 0;
+  /// Number of input bytes processed.
+  uint64_t bytes_processed = 0;
+  /// Number of 63-byte blocks processed.
+  uint64_t blocks_processed = 0;
+  /// Number of blocks that had no active marker and skipped the marker evaluation.
+  uint64_t blocks_skipped = 0;
+  /// Number of blocks that were interpreted while the kernel was compiled.
+  uint64_t blocks_interpreted = 0;
+  /// Size of the jitted machine code in bytes.
+  uint64_t code_size = 0;
+  /// The engine chosen by the planner, if it was used.
+  const char* plan = nullptr;
+
+  /// Time spent before the first block could be processed.
+  [[nodiscard]] double compile_seconds() const {
+    return parse_seconds + cc_compile_seconds + ir_build_seconds + optimize_seconds + codegen_seconds;
+  }
+
+  /// Time spent processing the input.
+  [[nodiscard]] double scan_seconds() const {
+    return transpose_seconds + kernel_seconds;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const Stats& stats) {
+    std::stringstream out;
+    auto ms = [&out](const char* name, double seconds) {
+      out << std::setw(20) << std::left << name << std::fixed << std::setprecision(3) << seconds * 1000 << " ms\n";
+    };
+    ms("parse", stats.parse_seconds);
+    ms("cc compile", stats.cc_compile_seconds);
+    ms("ir build", stats.ir_build_seconds);
+    ms("optimize", stats.optimize_seconds);
+    ms("codegen", stats.codegen_seconds);
+    ms("transpose", stats.transpose_seconds);
+    ms("kernel", stats.kernel_seconds);
+    out << std::setw(20) << std::left << "bytes processed" << stats.bytes_processed << "\n";
+    out << std::setw(20) << std::left << "blocks processed" << stats.blocks_processed << "\n";
+    out << std::setw(20) << std::left << "blocks skipped" << stats.blocks_skipped << "\n";
+    out << std::setw(20) << std::left << "blocks interpreted" << stats.blocks_interpreted << "\n";
+    out << std::setw(20) << std::left << "code size" << stats.code_size << " bytes\n";
+    if (stats.plan) {
+      out << std::setw(20) << std::left << "plan" << stats.plan << "\n";
+    }
+    return os << out.str();
+  }
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_STATS_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_TELEMETRY_H_
+#define INCLUDE_PARABIX_TELEMETRY_H_
+// ---------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// Hardware counters of a single scan or of all scans of a thread
+struct CounterRecord {
+  /// The engine that produced the record, or "thread" for per-thread totals.
+  std::string engine;
+  /// The matched pattern, empty for per-thread totals.
+  std::string pattern;
+  /// The thread that executed the scan.
+  std::thread::id thread;
+  /// Number of scans aggregated in this record.
+  uint64_t scans = 0;
+  /// Number of input bytes.
+  uint64_t bytes = 0;
+  /// Wall clock time in seconds.
+  double seconds = 0;
+  double cycles = 0;
+  double instructions = 0;
+  double l1_misses = 0;
+  double llc_misses = 0;
+  double branch_misses = 0;
+  /// False if the counters could not be opened, e.g. because of perf_event_paranoid.
+  bool counters_available = true;
+
+  [[nodiscard]] double ipc() const { return cycles > 0 ? instructions / cycles : 0; }
+
+  /// Add the counters of another record.
+  CounterRecord& operator+=(const CounterRecord& other);
+
+  /// Write the record as a single line of JSON.
+  void writeJson(std::ostream& os) const;
+};
+// ---------------------------------------------------------------------------
+// Opt-in hardware counter instrumentation of the matching APIs
+class Telemetry {
+  public:
+    /// Records are written as JSON lines to the given stream.
+    explicit Telemetry(std::ostream& output)
+      : output(output) {}
+
+    /// Install the process-wide sink used by the matching APIs, nullptr disables the instrumentation.
+    static void install(Telemetry* telemetry) { installed_.store(telemetry, std::memory_order_release); }
+
+    /// Get the installed sink.
+    static Telemetry* installed() { return installed_.load(std::memory_order_acquire); }
+
+    /// Measure the calling thread until the scope ends, does nothing if no sink is installed.
+    class Scope {
+      public:
+        Scope(const char* engine, const char* pattern, uint64_t bytes);
+
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        Telemetry* telemetry;
+        const char* engine;
+        const char* pattern;
+        uint64_t bytes;
+    };
+
+    /// Write a record and add it to the totals of its thread.
+    void record(const CounterRecord& record);
+
+    /// Get the accumulated counters per thread.
+    std::vector<CounterRecord> threadTotals();
+
+    /// Write the accumulated counters per thread.
+    void writeThreadTotals();
+
+  private:
+    static std::atomic<Telemetry*> installed_;
+
+    std::mutex mutex;
+    std::ostream& output;
+    std::unordered_map<std::thread::id, CounterRecord> totals;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_TELEMETRY_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,76 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_THREAD_POOL_H_
+#define INCLUDE_PARABIX_THREAD_POOL_H_
+// ---------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// Work stealing thread pool.
+// Every worker has its own queue, tasks submitted by a worker go to its own queue and run newest first,
+// idle workers steal the oldest task of another queue. Many small tasks thus stay with their producer,
+// while the big ones spread over all workers.
+class ThreadPool {
+  public:
+    /// Tasks that are waited for together.
+    class Group {
+      friend class ThreadPool;
+      std::atomic<size_t> pending{0};
+    };
+
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Run the task on one of the workers, tasks must not throw.
+    void submit(Group& group, std::function<void()> task);
+
+    /// Wait until all tasks of the group finished, the calling thread runs tasks in the meantime.
+    /// Workers may wait for the groups they submitted, the pool never blocks on nested tasks.
+    void wait(Group& group);
+
+    /// Number of workers.
+    [[nodiscard]] size_t size() const { return queues.size(); }
+
+  private:
+    struct Task {
+      Group* group;
+      std::function<void()> function;
+    };
+
+    struct Queue {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    /// Run a task of the own queue or steal one, returns false if there was none.
+    bool run_one(size_t self);
+
+    void work(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    /// Wakes the threads in wait when a task is queued or a group finished.
+    std::condition_variable progress;
+    /// Number of queued tasks, the workers sleep while it is zero.
+    std::atomic<size_t> queued{0};
+    /// Queue of external submissions, round robin.
+    std::atomic<size_t> next_queue{0};
+    bool stopping = false;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_THREAD_POOL_H_
+// ---------------------------------------------------------------------------
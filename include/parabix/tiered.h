@@ -0,0 +1,55 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_PARABIX_TIERED_H_
+#define INCLUDE_PARABIX_TIERED_H_
+// ---------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parabix/matcher.h"
+#include "parabix/stats.h"
+#include "parser/cc.h"
+// ---------------------------------------------------------------------------
+namespace parabix {
+// ---------------------------------------------------------------------------
+// Tiered execution of a pattern.
+// The pattern is compiled on a background thread while the calls interpret the blocks. Once the compiled kernel
+// is ready, it takes over at the next chunk boundary with the carries of the interpreter, so the first calls start
+// right away and the later ones run at JIT speed.
+class TieredMatcher {
+  public:
+    /// Start the compilation of the pattern, throws for options with records or a delimiter.
+    explicit TieredMatcher(const std::string& pattern, Matcher::Options options = {});
+    /// Waits for the compilation.
+    ~TieredMatcher();
+
+    TieredMatcher(const TieredMatcher&) = delete;
+    TieredMatcher& operator=(const TieredMatcher&) = delete;
+
+    /// Count the match end positions in the input, concurrent calls are safe.
+    uint64_t match(const char* input, size_t size, Stats* stats = nullptr) const;
+
+    /// True once the compiled kernel took over, false until then or if the compilation failed.
+    [[nodiscard]] bool compiled() const { return ready.load(std::memory_order_acquire); }
+    /// Wait for the end of the compilation.
+    void wait() const { compilation.wait(); }
+
+  private:
+    /// The source pattern, kept for the telemetry records.
+    std::string pattern;
+    /// The character classes of the pattern.
+    std::vector<parser::CC> cc_list;
+    /// The compiled kernel, set by the compilation before `ready`.
+    std::unique_ptr<Matcher> matcher;
+    std::atomic<bool> ready{false};
+    /// The background compilation, the last member so it ends before the others are destroyed.
+    std::shared_future<void> compilation;
+};
+// ---------------------------------------------------------------------------
+} // namespace parabix
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_PARABIX_TIERED_H_
+// ---------------------------------------------------------------------------
@@ -0,0 +1,63 @@
+// ---------------------------------------------------------------------------
+#ifndef INCLUDE_STREAM_ALIGNED_ALLOCATOR_H_
+#define INCLUDE_STREAM_ALIGNED_ALLOCATOR_H_
+// ---------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+// ---------------------------------------------------------------------------
+namespace stream {
+// ---------------------------------------------------------------------------
+// Allocator for cache line aligned storage.
+// Elements are default initialized, a resize does not touch the memory unless a value is given.
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator {
+  public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+      using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}  // NOLINT
+
+    T* allocate(size_t n) {
+      // aligned_alloc requires a multiple of the alignment
+      auto size = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+      auto* data = std::aligned_alloc(Alignment, size);
+      if (!data) {
+        throw std::bad_alloc();
+      }
+      return static_cast<T*>(data);
+    }
+
+    void deallocate(T* data, size_t) noexcept {
+      std::free(data);
+    }
+
+    template <typename U>
+    void construct(U* p) noexcept {
+      ::new(static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+      ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+// ---------------------------------------------------------------------------
+} // namespace stream
+// ---------------------------------------------------------------------------
+#endif  // INCLUDE_STREAM_ALIGNED_ALLOCATOR_H_
+// ---------------------------------------------------------------------------
@@ -2,10 +2,13 @@
 #ifndef INCLUDE_STREAM_BASIS_BIT_STREAM_H_
 #define INCLUDE_STREAM_BASIS_BIT_STREAM_H_
 // ---------------------------------------------------------------------------
+#include <cstdint>
 #include <vector>
 #include <sstream>
 #include <ostream>
 #include <immintrin.h>
+
+#include "stream/aligned_allocator.h"
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 namespace stream {
@@ -37,6 +40,14 @@ class BitStream {
       return blocks.size();
     }
 
+    [[nodiscard]] block_type* data() {
+      return blocks.data();
+    }
+
+    [[nodiscard]] const block_type* data() const {
+      return blocks.data();
+    }
+
     [[nodiscard]] size_t size() const {
       return blocks.size() * bits;
     }
@@ -63,6 +74,30 @@ class BitStream {
       return *this;
     }
 
+    /// Three operand forms, the result is written into this stream without temporaries.
+    /// The operands may be this stream. Streams larger than the last level cache are written with non-temporal stores.
+    BitStream& assign_and(const BitStream& a, const BitStream& b);
+
+    BitStream& assign_or(const BitStream& a, const BitStream& b);
+
+    BitStream& assign_xor(const BitStream& a, const BitStream& b);
+
+    /// a & ~b
+    BitStream& assign_and_not(const BitStream& a, const BitStream& b);
+
+    BitStream& assign_not(const BitStream& a);
+
+    BitStream& assign_add(const BitStream& a, const BitStream& b);
+
+    /// a >> offset, moves every bit `offset` positions forward.
+    BitStream& assign_shift(const BitStream& a, size_t offset);
+
+    /// Streams of at least this many bytes are written with non-temporal stores.
+    static size_t streaming_threshold();
+
+    /// Additions of streams with at least this many blocks run on all hardware threads.
+    static const size_t parallel_blocks = 1 << 20;
+
     BitStream operator+(const BitStream& other) const;
 
     BitStream operator&(const BitStream& other) const;
@@ -100,15 +135,24 @@ class BitStream {
     }
 
   protected:
+    /// Resize to the size of the other stream, new blocks are not initialized.
+    void resize_like(const BitStream& other) {
+      blocks.resize(other.blocks.size());
+    }
+
     void set(size_t pos);
 
     void clear(size_t pos);
 
     std::pair<size_t, size_t> find_block(size_t pos);
 
-    std::vector<block_type> blocks;
+    std::vector<block_type, AlignedAllocator<block_type>> blocks;
 };
 // ---------------------------------------------------------------------------
+/// Add two sequences of 63 bit blocks with carry-lookahead, returns the carry out of the last block.
+/// `dst` may be `a` or `b`.
+uint64_t add_blocks(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t n, uint64_t carry, bool streaming = false);
+// ---------------------------------------------------------------------------
 } // namespace stream
 // ---------------------------------------------------------------------------
 #endif  // INCLUDE_STREAM_BASIS_BIT_STREAM_H_
@@ -0,0 +1,117 @@
+#include "codegen/bytecode_compiler.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <stdexcept>
+
+using Bytecode = codegen::Bytecode;
+using BytecodeCompiler = codegen::BytecodeCompiler;
+using BitwiseExpression = codegen::BitwiseExpression;
+using ExprType = codegen::BitwiseExpression::Type;
+
+namespace {
+
+// apply the operation to the words of all blocks of the batch, four blocks per vector
+template <typename Operation>
+inline void for_each_vector(uint64_t* result, const uint64_t* left, const uint64_t* right, const uint64_t* other, Operation&& operation) {
+  for (size_t i = 0; i < Bytecode::BATCH; i += 4) {
+    auto l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+    auto r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+    auto o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), operation(l, r, o));
+  }
+}
+
+} // namespace
+
+void Bytecode::execute(uint64_t* registers) const {
+  for (auto& instruction : instructions) {
+    auto* result = registers + instruction.result * BATCH;
+    auto* left = registers + instruction.left * BATCH;
+    auto* right = registers + instruction.right * BATCH;
+    auto* other = registers + instruction.other * BATCH;
+    switch (instruction.op) {
+      case Op::And:
+        for_each_vector(result, left, right, other, [](__m256i l, __m256i r, __m256i) { return _mm256_and_si256(l, r); });
+        break;
+      case Op::AndNot:
+        // andnot negates its first operand
+        for_each_vector(result, left, right, other, [](__m256i l, __m256i r, __m256i) { return _mm256_andnot_si256(r, l); });
+        break;
+      case Op::Or:
+        for_each_vector(result, left, right, other, [](__m256i l, __m256i r, __m256i) { return _mm256_or_si256(l, r); });
+        break;
+      case Op::Not:
+        for_each_vector(result, left, right, other, [](__m256i l, __m256i, __m256i) {
+          return _mm256_xor_si256(l, _mm256_set1_epi64x(-1));
+        });
+        break;
+      case Op::Select:
+        for_each_vector(result, left, right, other, [](__m256i l, __m256i r, __m256i o) {
+          return _mm256_or_si256(_mm256_and_si256(l, r), _mm256_andnot_si256(l, o));
+        });
+        break;
+    }
+  }
+}
+
+Bytecode BytecodeCompiler::compile(const std::vector<std::unique_ptr<BitwiseExpression>>& expressions) {
+  bytecode = Bytecode();
+  values.clear();
+  for (auto& expression : expressions) {
+    bytecode.outputs.push_back(compileExpression(expression.get()));
+  }
+  return std::move(bytecode);
+}
+
+uint16_t BytecodeCompiler::compileExpression(BitwiseExpression* expression) {
+  switch (expression->getType()) {
+    case ExprType::Bit:
+      return static_cast<Bit*>(expression)->bit;
+    case ExprType::True:
+      return Bytecode::ONES;
+    case ExprType::False:
+      return Bytecode::ZERO;
+    case ExprType::Not:
+      return emit(Bytecode::Op::Not, compileExpression(static_cast<NotExpression*>(expression)->child.get()));
+    case ExprType::And: {
+      auto* binary = static_cast<BinaryExpression*>(expression);
+      // a negated operand becomes an and-not, the negation is not computed
+      if (binary->right->getType() == ExprType::Not) {
+        auto left = compileExpression(binary->left.get());
+        return emit(Bytecode::Op::AndNot, left, compileExpression(static_cast<NotExpression*>(binary->right.get())->child.get()));
+      }
+      if (binary->left->getType() == ExprType::Not) {
+        auto right = compileExpression(binary->right.get());
+        return emit(Bytecode::Op::AndNot, right, compileExpression(static_cast<NotExpression*>(binary->left.get())->child.get()));
+      }
+      auto left = compileExpression(binary->left.get());
+      auto right = compileExpression(binary->right.get());
+      return emit(Bytecode::Op::And, std::min(left, right), std::max(left, right));
+    }
+    case ExprType::Or: {
+      auto* binary = static_cast<BinaryExpression*>(expression);
+      auto left = compileExpression(binary->left.get());
+      auto right = compileExpression(binary->right.get());
+      return emit(Bytecode::Op::Or, std::min(left, right), std::max(left, right));
+    }
+    case ExprType::Selection: {
+      auto* selection = static_cast<SelectionExpression*>(expression);
+      auto if_register = compileExpression(selection->if_expr.get());
+      auto true_register = compileExpression(selection->true_expr.get());
+      return emit(Bytecode::Op::Select, if_register, true_register, compileExpression(selection->false_expr.get()));
+    }
+  }
+  throw std::runtime_error{"unknown expression type"};
+}
+
+uint16_t BytecodeCompiler::emit(Bytecode::Op op, uint16_t left, uint16_t right, uint16_t other) {
+  auto [it, inserted] = values.try_emplace({op, left, right, other}, static_cast<uint16_t>(bytecode.register_count));
+  if (inserted) {
+    if (bytecode.register_count == UINT16_MAX) {
+      throw std::runtime_error{"the expressions need too many registers."};
+    }
+    bytecode.instructions.push_back({op, it->second, left, right, other});
+    ++bytecode.register_count;
+  }
+  return it->second;
+}
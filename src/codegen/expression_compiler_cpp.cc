@@ -67,6 +67,15 @@ std::string ExpressionCompilerCpp::compile(BitwiseExpression& expression) {
    return output.str();
 }
 
+std::string ExpressionCompilerCpp::compile(const std::vector<std::unique_ptr<BitwiseExpression>>& expressions) {
+   reset();
+   for (size_t i = 0; i < expressions.size(); ++i) {
+      auto generated = compileExpression(expressions[i].get());
+      output << "  const uint64_t cc_" << i << " = " << generated << ";\n";
+   }
+   return output.str();
+}
+
 std::string ExpressionCompilerCpp::compileExpression(BitwiseExpression* expression) {
    switch (expression->getType()) {
       case ExprType::True:
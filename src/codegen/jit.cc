@@ -1,42 +1,125 @@
 #include "codegen/jit.h"
 
-#include <llvm/IR/LegacyPassManager.h>
-#include <llvm/Transforms/Scalar.h>
-#include <llvm/Transforms/Scalar/GVN.h>
-#include <llvm/Transforms/InstCombine/InstCombine.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/Host.h>
 #include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <chrono> // NOLINT
 
 using JIT = codegen::JIT;
+using OptimizationLevel = codegen::OptimizationLevel;
 
 namespace {
 
-static void optimizeModule(llvm::Module& module) {
-    // Create a function pass manager
-    auto passManager = std::make_unique<llvm::legacy::FunctionPassManager>(&module);
+#if LLVM_VERSION_MAJOR >= 14
+using PassBuilderLevel = llvm::OptimizationLevel;
+#else
+using PassBuilderLevel = llvm::PassBuilder::OptimizationLevel;
+#endif
 
-    // Add passes
-    passManager->add(llvm::createInstructionCombiningPass());
-    passManager->add(llvm::createReassociatePass());
-    passManager->add(llvm::createGVNPass());
-    passManager->add(llvm::createCFGSimplificationPass());
-    passManager->doInitialization();
+static PassBuilderLevel getPassBuilderLevel(OptimizationLevel level) {
+    switch (level) {
+        case OptimizationLevel::O0: return PassBuilderLevel::O0;
+        case OptimizationLevel::O1: return PassBuilderLevel::O1;
+        case OptimizationLevel::O2: return PassBuilderLevel::O2;
+        case OptimizationLevel::O3: return PassBuilderLevel::O3;
+    }
+    llvm_unreachable("all optimization levels should be handled properly");
+}
 
-    // Run the optimizations
-    for (auto& fn: module) {
-        passManager->run(fn);
+static llvm::CodeGenOpt::Level getCodeGenLevel(OptimizationLevel level) {
+    switch (level) {
+        case OptimizationLevel::O0: return llvm::CodeGenOpt::None;
+        case OptimizationLevel::O1: return llvm::CodeGenOpt::Less;
+        case OptimizationLevel::O2: return llvm::CodeGenOpt::Default;
+        case OptimizationLevel::O3: return llvm::CodeGenOpt::Aggressive;
+    }
+    llvm_unreachable("all optimization levels should be handled properly");
+}
+
+static llvm::TargetMachine* selectHostTarget(OptimizationLevel level) {
+    // Target the host cpu, otherwise the vectorizers only see the generic x86-64 feature set
+    llvm::SmallVector<std::string, 16> attributes;
+    llvm::StringMap<bool> features;
+    if (llvm::sys::getHostCPUFeatures(features)) {
+        for (auto& feature : features) {
+            attributes.push_back((feature.second ? "+" : "-") + feature.first().str());
+        }
+    }
+    return llvm::EngineBuilder()
+        .setOptLevel(getCodeGenLevel(level))
+        .setMCPU(llvm::sys::getHostCPUName())
+        .setMAttrs(attributes)
+        .selectTarget();
+}
+
+/// Section memory manager that keeps track of the emitted code size
+class CountingMemoryManager: public llvm::SectionMemoryManager {
+    public:
+    explicit CountingMemoryManager(uint64_t& code_size)
+      : code_size(code_size) {}
+
+    uint8_t* allocateCodeSection(uintptr_t size, unsigned alignment, unsigned section_id, llvm::StringRef section_name) override {
+        code_size += size;
+        return llvm::SectionMemoryManager::allocateCodeSection(size, alignment, section_id, section_name);
     }
+
+    private:
+    uint64_t& code_size;
+};
+
+static void optimizeModule(llvm::Module& module, llvm::TargetMachine& target_machine, OptimizationLevel level) {
+    if (level == OptimizationLevel::O0) {
+        return;
+    }
+
+    // Loop unrolling is cheap enough for every level, the vectorizers are reserved for O2 and O3
+    llvm::PipelineTuningOptions tuning;
+    tuning.LoopUnrolling = true;
+    tuning.LoopInterleaving = level != OptimizationLevel::O1;
+    tuning.LoopVectorization = level != OptimizationLevel::O1;
+    tuning.SLPVectorization = level != OptimizationLevel::O1;
+
+    llvm::LoopAnalysisManager loop_analysis;
+    llvm::FunctionAnalysisManager function_analysis;
+    llvm::CGSCCAnalysisManager cgscc_analysis;
+    llvm::ModuleAnalysisManager module_analysis;
+
+#if LLVM_VERSION_MAJOR >= 13
+    llvm::PassBuilder pass_builder(&target_machine, tuning);
+#else
+    llvm::PassBuilder pass_builder(false, &target_machine, tuning);
+#endif
+
+    // Register the analyses and make them available to each other
+    pass_builder.registerModuleAnalyses(module_analysis);
+    pass_builder.registerCGSCCAnalyses(cgscc_analysis);
+    pass_builder.registerFunctionAnalyses(function_analysis);
+    pass_builder.registerLoopAnalyses(loop_analysis);
+    pass_builder.crossRegisterProxies(loop_analysis, function_analysis, cgscc_analysis, module_analysis);
+
+    // Run the optimizations
+    auto pass_manager = pass_builder.buildPerModuleDefaultPipeline(getPassBuilderLevel(level));
+    pass_manager.run(module, module_analysis);
 }
 
 }  // namespace
 
-JIT::JIT(llvm::orc::ThreadSafeContext& ctx)
-  : target_machine(llvm::EngineBuilder().selectTarget()),
+JIT::JIT(llvm::orc::ThreadSafeContext& ctx, OptimizationLevel level)
+  : target_machine(selectHostTarget(level)),
     data_layout(target_machine->createDataLayout()),
     execution_session(),
     context(ctx),
-    object_layer(execution_session, []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
+    level(level),
+    object_layer(execution_session, [this]() { return std::make_unique<CountingMemoryManager>(statistics.code_size); }),
     compile_layer(execution_session, object_layer, std::make_unique<llvm::orc::SimpleCompiler>(*target_machine)),
-    optimize_layer(execution_session, compile_layer, [] (llvm::orc::ThreadSafeModule m, const llvm::orc::MaterializationResponsibility&) { optimizeModule(*m.getModuleUnlocked()); return m; }),
+    optimize_layer(execution_session, compile_layer, [this] (llvm::orc::ThreadSafeModule m, const llvm::orc::MaterializationResponsibility&) {
+        auto tick = std::chrono::steady_clock::now();
+        optimizeModule(*m.getModuleUnlocked(), *target_machine, this->level);
+        statistics.optimize_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - tick).count();
+        return m;
+    }),
     mainDylib(cantFail(execution_session.createJITDylib("<main>"), "createJITDylib failed")) {
   // Lookup symbols in host process
   auto generator = llvm::cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
@@ -46,6 +129,9 @@ JIT::JIT(llvm::orc::ThreadSafeContext& ctx)
 }
 
 llvm::Error JIT::addModule(std::unique_ptr<llvm::Module> module) {
+    // The optimizer needs the target description to model the costs of the host
+    module->setDataLayout(data_layout);
+    module->setTargetTriple(target_machine->getTargetTriple().str());
     return optimize_layer.add(mainDylib, llvm::orc::ThreadSafeModule{move(module), context});
 }
 
@@ -0,0 +1,168 @@
+#include "codegen/kernel_compiler_cpp.h"
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include "codegen/cc_compiler.h"
+#include "codegen/expression_compiler_cpp.h"
+#include "parser/re_parser.h"
+
+using KernelCompilerCpp = codegen::KernelCompilerCpp;
+
+namespace {
+
+// the pattern as a C++ string literal
+std::string literal(const std::string& pattern) {
+  std::string result = "\"";
+  for (auto c : pattern) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result + "\"";
+}
+
+bool is_identifier(const std::string& name) {
+  if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+    return false;
+  }
+  return std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+}
+
+} // namespace
+
+KernelCompilerCpp::Kernel KernelCompilerCpp::compile(const std::string& name, const std::vector<std::string>& patterns) {
+  if (!is_identifier(name)) {
+    throw std::runtime_error{"kernel name is not an identifier: " + name};
+  }
+  if (patterns.empty()) {
+    throw std::runtime_error{"kernel without patterns"};
+  }
+
+  // the character classes of all patterns, pattern p starts at first[p]
+  parser::ReParser parser;
+  std::vector<std::vector<parser::CC>> cc_lists;
+  std::vector<size_t> first;
+  size_t cc_count = 0;
+  for (auto& pattern : patterns) {
+    cc_lists.push_back(parser.parse(pattern.c_str()));
+    if (cc_lists.back().empty()) {
+      throw std::runtime_error{"pattern without character classes: " + pattern};
+    }
+    first.push_back(cc_count);
+    cc_count += cc_lists.back().size();
+  }
+
+  CCCompiler cc_compiler;
+  std::vector<std::unique_ptr<BitwiseExpression>> expressions;
+  for (auto& cc_list : cc_lists) {
+    for (auto& cc : cc_list) {
+      expressions.push_back(cc_compiler.compile(cc));
+    }
+  }
+  ExpressionCompilerCpp expression_compiler;
+  auto statements = expression_compiler.compile(expressions);
+
+  Kernel kernel;
+  std::stringstream header;
+  header << "// Generated by parabix_generate, do not edit.\n"
+         << "#ifndef PARABIX_GENERATED_" << name << "_H_\n"
+         << "#define PARABIX_GENERATED_" << name << "_H_\n\n"
+         << "#include <cstddef>\n"
+         << "#include <cstdint>\n\n"
+         << "namespace " << name << " {\n\n"
+         << "  /// Number of patterns of the kernel.\n"
+         << "  constexpr size_t PATTERNS = " << patterns.size() << ";\n\n"
+         << "  /// The patterns, in the order of the counts.\n"
+         << "  extern const char* const patterns[PATTERNS];\n\n"
+         << "  /// Count the match end positions of every pattern in a single pass, `counts` holds PATTERNS values.\n"
+         << "  void match_all(const char* input, size_t size, uint64_t* counts);\n\n"
+         << "  /// Count the match end positions of the pattern with the index, throws if there is no such pattern.\n"
+         << "  uint64_t match(size_t index, const char* input, size_t size);\n\n"
+         << "} // namespace " << name << "\n\n"
+         << "#endif  // PARABIX_GENERATED_" << name << "_H_\n";
+  kernel.header = header.str();
+
+  std::stringstream source;
+  source << "// Generated by parabix_generate, do not edit.\n"
+         << "#include \"" << name << ".h\"\n"
+         << "#include <popcntintrin.h>\n"
+         << "#include <algorithm>\n"
+         << "#include <array>\n"
+         << "#include <stdexcept>\n"
+         << "#include \"parabix/bit.h\"\n\n"
+         << "namespace {\n\n"
+         << "const size_t BLOCK_SIZE = 63;\n"
+         << "const uint64_t CARRY_BIT = 1ULL << BLOCK_SIZE;\n"
+         << "// number of blocks that are transposed at once, 256 * 8 basis words fit into L1\n"
+         << "const size_t CHUNK_BLOCKS = 256;\n"
+         << "const size_t CARRIES = " << cc_count << ";\n\n"
+         << "void run_block(const std::array<uint64_t, 8>& basis, uint64_t* carry, uint64_t* counts) {\n";
+  for (auto i = 0; i < ENCODING_BITS; ++i) {
+    source << "  const uint64_t bit_" << i << " = basis[" << (ENCODING_BITS - 1) - i << "];\n";
+  }
+  source << statements;
+
+  for (size_t p = 0; p < patterns.size(); ++p) {
+    auto& cc_list = cc_lists[p];
+    auto base = first[p];
+    // a block without a first character and without incoming carries cannot produce any marker
+    source << "\n  // " << literal(patterns[p]) << "\n"
+           << "  if ((cc_" << base;
+    for (size_t i = 0; i < cc_list.size(); ++i) {
+      source << " | carry[" << base + i << "]";
+    }
+    source << ") != 0) {\n"
+           << "    uint64_t marker = cc_" << base << ";\n"
+           << "    uint64_t next;\n";
+    for (size_t i = 0; i < cc_list.size(); ++i) {
+      auto cc = "cc_" + std::to_string(base + i);
+      auto carry = "carry[" + std::to_string(base + i) + "]";
+      if (cc_list[i].isStar()) {
+        // MatchStar
+        source << "    next = (marker & " << cc << ") + " << cc << " + " << carry << ";\n"
+               << "    " << carry << " = next >> BLOCK_SIZE;\n"
+               << "    marker = ((next & ~CARRY_BIT) ^ " << cc << ") | marker;\n";
+      } else {
+        // Advance
+        source << "    next = ((marker & " << cc << ") << 1) | " << carry << ";\n"
+               << "    " << carry << " = next >> BLOCK_SIZE;\n"
+               << "    marker = next & ~CARRY_BIT;\n";
+      }
+    }
+    source << "    counts[" << p << "] += _mm_popcnt_u64(marker);\n"
+           << "  }\n";
+  }
+  source << "}\n\n"
+         << "} // namespace\n\n"
+         << "const char* const " << name << "::patterns[PATTERNS] = {\n";
+  for (auto& pattern : patterns) {
+    source << "  " << literal(pattern) << ",\n";
+  }
+  source << "};\n\n"
+         << "void " << name << "::match_all(const char* input, size_t size, uint64_t* counts) {\n"
+         << "  std::fill_n(counts, PATTERNS, 0);\n"
+         << "  std::array<uint64_t, CARRIES> carry{};\n"
+         << "  std::array<std::array<uint64_t, 8>, CHUNK_BLOCKS> chunk;\n"
+         << "  // one position more than the input for the markers behind the last character\n"
+         << "  for (size_t block = 0, blocks = size / BLOCK_SIZE + 1; block < blocks; block += CHUNK_BLOCKS) {\n"
+         << "    auto count = std::min(CHUNK_BLOCKS, blocks - block);\n"
+         << "    parabix::transpose_blocks(input, size, block, count, chunk.data());\n"
+         << "    for (size_t c = 0; c < count; ++c) {\n"
+         << "      run_block(chunk[c], carry.data(), counts);\n"
+         << "    }\n"
+         << "  }\n"
+         << "}\n\n"
+         << "uint64_t " << name << "::match(size_t index, const char* input, size_t size) {\n"
+         << "  if (index >= PATTERNS) {\n"
+         << "    throw std::runtime_error{\"pattern index out of range\"};\n"
+         << "  }\n"
+         << "  std::array<uint64_t, PATTERNS> counts;\n"
+         << "  match_all(input, size, counts.data());\n"
+         << "  return counts[index];\n"
+         << "}\n";
+  kernel.source = source.str();
+  return kernel;
+}
@@ -33,3 +33,11 @@ std::pair<llvm::Value*, llvm::Value*> OperationBuilder::buildMatchStar(llvm::Val
 
   return {result_bit_stream, carry};
 }
+
+std::pair<llvm::Value*, llvm::Value*> OperationBuilder::buildScanThru(llvm::Value* CC, llvm::Value* M, llvm::Value* CARRY) {
+  auto result_bit_stream = builder.CreateAdd(M, builder.CreateAdd(CC, CARRY));
+  auto carry = builder.CreateAnd(builder.CreateLShr(result_bit_stream, 63), 1);
+  result_bit_stream = builder.CreateAnd(result_bit_stream, builder.CreateAnd(builder.CreateNot(CC), CLEAR_LAST_BIT));
+
+  return {result_bit_stream, carry};
+}
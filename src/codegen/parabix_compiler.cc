@@ -2,14 +2,16 @@
 #include "codegen/cc_compiler.h"
 #include "codegen/expression_builder.h"
 #include "codegen/operation_builder.h"
+#include <chrono> // NOLINT
 
 using ParabixCompiler = codegen::ParabixCompiler;
 using ExpressionBuilder = codegen::ExpressionBuilder;
 using OperationBuilder = codegen::OperationBuilder;
 using CCCompiler = codegen::CCCompiler;
+using BitwiseExpression = codegen::BitwiseExpression;
 
-void ParabixCompiler::compile(const std::vector<parser::CC>& cc_list, bool verbose) {
-  compileRun(cc_list);
+void ParabixCompiler::compile(const std::vector<parser::CC>& cc_list, bool verbose, bool records, const std::optional<parser::CC>& delimiter) {
+  compileRun(cc_list, records || delimiter.has_value(), delimiter);
   if (verbose) {
     module->print(llvm::errs(), nullptr);
   }
@@ -17,19 +19,42 @@ void ParabixCompiler::compile(const std::vector<parser::CC>& cc_list, bool verbo
   if (error) {
     throw std::runtime_error{"cannot add a module to JIT"};
   }
+
+  // The module is materialized lazily by the first lookup
+  auto tick = std::chrono::steady_clock::now();
   runFnPtr = reinterpret_cast<decltype(runFnPtr)>(jit.getPointerToFunction("run"));
+  auto materialize_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tick).count();
+
+  auto& jit_statistics = jit.getStatistics();
+  statistics.optimize_seconds = jit_statistics.optimize_seconds;
+  statistics.codegen_seconds = std::max(0.0, materialize_seconds - jit_statistics.optimize_seconds);
+  statistics.code_size = jit_statistics.code_size;
 }
 
-void ParabixCompiler::compileRun(const std::vector<parser::CC>& cc_list) {
+void ParabixCompiler::compileRun(const std::vector<parser::CC>& cc_list, bool records, const std::optional<parser::CC>& delimiter) {
   auto& ctx = *context.getContext();
   llvm::IRBuilder<> builder(ctx);
+  if (cc_list.empty()) {
+    throw std::runtime_error{"the pattern does not contain any character class."};
+  }
+
+  auto tick = std::chrono::steady_clock::now();
+  CCCompiler cc_compiler;
+  std::vector<std::unique_ptr<BitwiseExpression>> expressions;
+  expressions.reserve(cc_list.size());
+  for (auto& cc : cc_list) {
+    expressions.push_back(cc_compiler.compile(cc));
+  }
+  auto tock = std::chrono::steady_clock::now();
+  statistics.cc_compile_seconds = std::chrono::duration<double>(tock - tick).count();
 
-  // define void @run(i64* %basis, i64* %cc, i64* %marker, *i64 %carry) {
-  auto funcType = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), {
+  // define i8 @run(i64* %basis, i64* %cc, i64* %marker, *i64 %carry, i64 %boundary) {
+  auto funcType = llvm::FunctionType::get(llvm::Type::getInt8Ty(ctx), {
+      llvm::PointerType::getInt64PtrTy(ctx),
       llvm::PointerType::getInt64PtrTy(ctx),
       llvm::PointerType::getInt64PtrTy(ctx),
       llvm::PointerType::getInt64PtrTy(ctx),
-      llvm::PointerType::getInt64PtrTy(ctx)
+      llvm::Type::getInt64Ty(ctx)
     },
     false
   );
@@ -43,21 +68,52 @@ void ParabixCompiler::compileRun(const std::vector<parser::CC>& cc_list) {
   for(llvm::Function::arg_iterator ai = func->arg_begin(), ae = func->arg_end(); ai != ae; ++ai) {
       funcArgs.push_back(&*ai);
   }
-  if(funcArgs.size() != 4) {
+  if(funcArgs.size() != 5) {
       throw std::runtime_error{"LLVM: run() does not have enough arguments"};
   }
   auto basis = funcArgs[0];
   auto cc = funcArgs[1];
   auto marker = funcArgs[2];
   auto carry = funcArgs[3];
+  auto boundary = funcArgs[4];
 
-  CCCompiler cc_compiler;
   ExpressionBuilder expression_builder(builder, basis);
   OperationBuilder operation_builder(builder);
 
+  if (delimiter) {
+    // the delimiters are derived from the basis bits like any other character class, negations set the last bit
+    auto* delimiters = expression_builder.codegen(cc_compiler.compile(*delimiter).get());
+    boundary = builder.CreateOr(boundary, builder.CreateAnd(delimiters, builder.getInt64(~(1ULL << 63))));
+  }
+  if (records) {
+    builder.CreateStore(boundary, builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), cc, cc_list.size(), "boundary_ptr"));
+  }
+
+  // The character classes never match at a record boundary
+  auto* inside = records ? builder.CreateNot(boundary) : nullptr;
+  auto cc_codegen = [&](size_t i) {
+    auto* value = expression_builder.codegen(expressions[i].get());
+    return records ? builder.CreateAnd(value, inside) : value;
+  };
+
+  // A block without a first character and without incoming carries cannot produce any marker
+  auto* active = cc_codegen(0);
+  for (size_t i = 0, end = cc_list.size() + (records ? 1 : 0); i < end; ++i) {
+    auto* carry_ptr = builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), carry, i, "carry_ptr");
+    active = builder.CreateOr(active, builder.CreateLoad(builder.getInt64Ty(), carry_ptr));
+  }
+  auto* skipBlock = llvm::BasicBlock::Create(ctx, "skip", func);
+  auto* bodyBlock = llvm::BasicBlock::Create(ctx, "body", func);
+  builder.CreateCondBr(builder.CreateICmpEQ(active, builder.getInt64(0)), skipBlock, bodyBlock);
+
+  // skip:
+  builder.SetInsertPoint(skipBlock);
+  builder.CreateRet(builder.getInt8(1));
+
+  // body:
+  builder.SetInsertPoint(bodyBlock);
   for (size_t i = 0, end = cc_list.size(); i < end; ++i) {
-    auto expression = cc_compiler.compile(cc_list[i]);
-    auto* cc_value = expression_builder.codegen(expression.get());
+    auto* cc_value = cc_codegen(i);
     auto* cc_ptr = builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), cc, i, "cc_ptr");
     builder.CreateStore(cc_value, cc_ptr);
 
@@ -76,12 +132,27 @@ void ParabixCompiler::compileRun(const std::vector<parser::CC>& cc_list) {
     builder.CreateStore(next_carry, carry_ptr);
   }
 
-  builder.CreateRetVoid();
+  if (records) {
+    // scan the final markers through the rest of their record, they stop at the record boundary
+    auto size = cc_list.size();
+    auto* final_marker = builder.CreateLoad(builder.getInt64Ty(), builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), marker, size));
+    auto* carry_ptr = builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), carry, size, "record_carry_ptr");
+    auto* carry_value = builder.CreateLoad(builder.getInt64Ty(), carry_ptr);
+    // markers at a boundary are hits already, they must not add up with a marker that arrives there
+    auto* inside_record = builder.CreateAnd(inside, builder.getInt64(~(1ULL << 63)));
+    auto [hits, next_carry] = operation_builder.buildScanThru(inside_record, builder.CreateAnd(final_marker, inside_record), carry_value);
+    hits = builder.CreateOr(hits, builder.CreateAnd(final_marker, boundary));
+    builder.CreateStore(hits, builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), marker, size + 1, "hits_ptr"));
+    builder.CreateStore(next_carry, carry_ptr);
+  }
+
+  builder.CreateRet(builder.getInt8(0));
+  statistics.ir_build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tock).count();
 }
 
-void ParabixCompiler::run(uint64_t* basis, uint64_t* cc, uint64_t* marker, uint64_t* carry) {
+bool ParabixCompiler::run(uint64_t* basis, uint64_t* cc, uint64_t* marker, uint64_t* carry, uint64_t boundary) const {
   if (runFnPtr == nullptr) {
     throw std::runtime_error{"the run method is not initialized."};
   }
-  runFnPtr(basis, cc, marker, carry);
+  return runFnPtr(basis, cc, marker, carry, boundary) != 0;
 }
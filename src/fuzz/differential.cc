@@ -0,0 +1,287 @@
+#include "fuzz/differential.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iomanip>
+#include <regex>
+#include <sstream>
+
+#include "parabix/dfa.h"
+#include "parabix/parabix.h"
+#include "parser/re_parser.h"
+
+using Differential = fuzz::Differential;
+using Case = fuzz::Case;
+using Result = fuzz::Result;
+
+namespace {
+
+const size_t BLOCK_SIZE = 63;
+
+// characters of the generated patterns, few enough to produce many matches
+const char PATTERN_ALPHABET[] = "abcd0123";
+
+// characters of the generated inputs, a superset of the pattern alphabet
+const char INPUT_ALPHABET[] = "abcdexyz012349 ";
+
+std::vector<parser::CC> parse(const std::string& pattern) {
+  parser::ReParser parser;
+  return parser.parse(pattern.c_str());
+}
+
+// the pattern of the character classes in the ReParser grammar
+std::string to_pattern(const std::vector<parser::CC>& cc_list) {
+  std::string pattern;
+  for (auto& cc : cc_list) {
+    auto ranges = cc.getRanges();
+    if (ranges.size() == 1 && ranges[0].first == ranges[0].second) {
+      pattern += ranges[0].first;
+    } else {
+      pattern += '[';
+      for (auto& [low, high] : ranges) {
+        pattern += low;
+        pattern += '-';
+        pattern += high;
+      }
+      pattern += ']';
+    }
+    if (cc.isStar()) {
+      pattern += '*';
+    }
+  }
+  return pattern;
+}
+
+// the character class as ECMAScript bracket expression
+std::string to_ecmascript(const parser::CC& cc) {
+  auto escape = [](char c) {
+    return std::strchr("^$\\.*+?()[]{}|-/", c) ? std::string("\\") + c : std::string(1, c);
+  };
+  std::string result = "[";
+  for (auto& [low, high] : cc.getRanges()) {
+    result += escape(low);
+    if (low != high) {
+      result += "-" + escape(high);
+    }
+  }
+  return result + "]";
+}
+
+// characters of the alphabet that the character class matches
+std::string members(parser::CC cc, const char* alphabet) {
+  std::string result;
+  for (auto* c = alphabet; *c; ++c) {
+    if (cc.match(*c)) {
+      result += *c;
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+std::ostream& fuzz::operator<<(std::ostream& os, const Case& c) {
+  auto literal = [](const std::string& text) {
+    std::stringstream out;
+    out << '"';
+    for (auto c : text) {
+      auto u = static_cast<unsigned char>(c);
+      if (c == '"' || c == '\\') {
+        out << '\\' << c;
+      } else if (u >= 0x20 && u < 0x7f) {
+        out << c;
+      } else {
+        out << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<unsigned>(u) << std::dec;
+      }
+    }
+    out << '"';
+    return out.str();
+  };
+  return os << "pattern = " << literal(c.pattern) << ", input = " << literal(c.input) << " (" << c.input.size() << " bytes)";
+}
+
+Differential::Differential(Options options)
+  : options(options)
+  , random(options.seed)
+  , context(std::make_unique<llvm::LLVMContext>()) {}
+
+std::string Differential::next_pattern() {
+  auto alphabet_size = std::strlen(PATTERN_ALPHABET);
+  std::vector<parser::CC> cc_list;
+  for (auto n = 1 + random.uniform(options.max_cc); n > 0; --n) {
+    std::vector<std::pair<char, char>> ranges;
+    for (auto r = random.chance(0.2) ? 2 : 1; r > 0; --r) {
+      auto low = PATTERN_ALPHABET[random.uniform(alphabet_size)];
+      auto high = low;
+      // ranges stay within the letters or within the digits
+      while (random.chance(0.4) && std::isalpha(high) == std::isalpha(high + 1) && std::strchr(PATTERN_ALPHABET, high + 1)) {
+        ++high;
+      }
+      ranges.emplace_back(low, high);
+    }
+    cc_list.emplace_back(ranges, random.chance(0.3));
+  }
+  return to_pattern(cc_list);
+}
+
+std::string Differential::next_input(const std::string& pattern) {
+  auto cc_list = parse(pattern);
+  std::vector<std::string> cc_members;
+  std::string noise;
+  for (auto* c = INPUT_ALPHABET; *c; ++c) {
+    auto used = false;
+    for (auto& cc : cc_list) {
+      used = used || cc.match(*c);
+    }
+    if (!used) {
+      noise += *c;
+    }
+  }
+  for (auto& cc : cc_list) {
+    cc_members.push_back(members(cc, INPUT_ALPHABET));
+  }
+
+  // lengths around multiples of the block size are the interesting ones
+  size_t length;
+  if (random.chance(0.5)) {
+    auto blocks = random.uniform(options.max_length / BLOCK_SIZE + 1);
+    length = std::max<int64_t>(0, static_cast<int64_t>(blocks * BLOCK_SIZE) + static_cast<int64_t>(random.uniform(3)) - 1);
+  } else {
+    length = random.uniform(options.max_length + 1);
+  }
+
+  auto pick = [&](const std::string& chars) { return chars[random.uniform(chars.size())]; };
+  auto instance = [&](uint64_t max_repeat) {
+    std::string result;
+    for (size_t i = 0; i < cc_list.size(); ++i) {
+      for (auto count = cc_list[i].isStar() ? random.uniform(max_repeat + 1) : 1; count > 0; --count) {
+        result += pick(cc_members[i]);
+      }
+    }
+    return result;
+  };
+
+  std::string input;
+  switch (random.uniform(3)) {
+    case 0:
+      // random characters, mostly members of the character classes
+      while (input.size() < length) {
+        input += noise.empty() || random.chance(0.7) ? pick(cc_members[random.uniform(cc_list.size())]) : pick(noise);
+      }
+      break;
+    case 1:
+      // matches that straddle the block boundaries
+      while (input.size() < length) {
+        input += noise.empty() ? pick(INPUT_ALPHABET) : pick(noise);
+      }
+      for (auto boundary = BLOCK_SIZE; boundary < length; boundary += BLOCK_SIZE) {
+        auto match = instance(3);
+        auto begin = boundary - std::min<size_t>(boundary, random.uniform(match.size() + 1));
+        input.replace(begin, std::min(match.size(), length - begin), match, 0, std::min(match.size(), length - begin));
+      }
+      break;
+    default:
+      // matches with long star runs that cross several blocks
+      while (input.size() < length) {
+        input += instance(200);
+        input += noise.empty() ? pick(INPUT_ALPHABET) : pick(noise);
+      }
+      break;
+  }
+  input.resize(length);
+  return input;
+}
+
+Case Differential::next() {
+  auto pattern = next_pattern();
+  return {pattern, next_input(pattern)};
+}
+
+uint64_t Differential::regex_count(const Case& c) {
+  auto cc_list = parse(c.pattern);
+  // every match starts with a character of the first class, even if it is a star
+  std::string expression = "(?=" + to_ecmascript(cc_list[0]) + ")";
+  auto all_star = true;
+  for (auto& cc : cc_list) {
+    expression += to_ecmascript(cc) + (cc.isStar() ? "*" : "");
+    all_star = all_star && cc.isStar();
+  }
+  std::regex regex(expression + "$");
+
+  uint64_t matched = 0;
+  for (size_t end = 0; end <= c.input.size(); ++end) {
+    auto found = std::regex_search(c.input.begin(), c.input.begin() + static_cast<int64_t>(end), regex);
+    // the lookahead cannot see behind the searched range, that only matters for the empty match
+    found = found || (all_star && end < c.input.size() && cc_list[0].match(c.input[end]));
+    matched += found;
+  }
+  return matched;
+}
+
+std::vector<Result> Differential::run(const Case& c) {
+  std::vector<Result> results;
+  auto input = c.input;
+  results.push_back({"DFA", parabix::DFA(parse(c.pattern)).match(input.data(), input.size())});
+  results.push_back({"parabix-cpp", parabix::parabix_cpp(input, c.pattern.c_str())});
+  if (options.llvm) {
+    results.push_back({"parabix-llvm", parabix::parabix_llvm(context, input, c.pattern.c_str())});
+  }
+  results.push_back({"bit-stream", parabix::parabix_bit_stream(input, c.pattern.c_str())});
+  results.push_back({"fused", parabix::parabix_fused(input, c.pattern.c_str())});
+  if (input.size() <= options.max_regex_length) {
+    results.push_back({"std::regex", regex_count(c)});
+  }
+  return results;
+}
+
+bool Differential::check(const Case& c) {
+  auto results = run(c);
+  return std::all_of(results.begin(), results.end(), [&](auto& result) { return result.matched == results[0].matched; });
+}
+
+Case Differential::shrink(Case c) {
+  for (auto progress = true; progress;) {
+    progress = false;
+
+    // fewer and simpler character classes
+    auto cc_list = parse(c.pattern);
+    for (size_t i = 0; i < cc_list.size() && cc_list.size() > 1;) {
+      auto candidate = cc_list;
+      candidate.erase(candidate.begin() + static_cast<int64_t>(i));
+      if (!check({to_pattern(candidate), c.input})) {
+        cc_list = candidate;
+        c.pattern = to_pattern(cc_list);
+        progress = true;
+      } else {
+        ++i;
+      }
+    }
+    for (auto& cc : cc_list) {
+      if (cc.isStar()) {
+        auto star = cc;
+        cc = parser::CC(cc.getRanges());
+        if (!check({to_pattern(cc_list), c.input})) {
+          c.pattern = to_pattern(cc_list);
+          progress = true;
+        } else {
+          cc = star;
+        }
+      }
+    }
+
+    // shorter input, remove chunks of decreasing size
+    for (auto chunk = std::max<size_t>(c.input.size() / 2, 1); chunk > 0 && !c.input.empty(); chunk /= 2) {
+      for (size_t begin = 0; begin < c.input.size();) {
+        auto candidate = c.input;
+        candidate.erase(begin, chunk);
+        if (!check({c.pattern, candidate})) {
+          c.input = candidate;
+          progress = true;
+        } else {
+          begin += chunk;
+        }
+      }
+    }
+  }
+  return c;
+}
@@ -0,0 +1,197 @@
+#include "generator/input_generator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "parser/re_parser.h"
+
+using InputGenerator = generator::InputGenerator;
+using Random = generator::Random;
+
+InputGenerator::InputGenerator(Options options)
+  : options(std::move(options))
+  , max_line(1)
+  , separator_(0)
+  , planted(0) {
+  parser::ReParser parser;
+  cc_list = parser.parse(this->options.pattern.c_str());
+  if (cc_list.empty()) {
+    throw std::runtime_error{"the pattern does not contain any character class."};
+  }
+  this->options.threads = std::max(1U, this->options.threads);
+  this->options.chunk_size = std::max<uint64_t>(this->options.chunk_size, 4096);
+
+  // the separator must not be part of any character class, so matches cannot span lines
+  for (auto candidate : {'\n', ' ', '|', '\t', '_', '-', ';'}) {
+    auto used = false;
+    for (auto& cc : cc_list) {
+      used = used || cc.match(candidate);
+    }
+    if (!used) {
+      separator_ = candidate;
+      break;
+    }
+  }
+  if (separator_ == 0) {
+    throw std::runtime_error{"cannot find a line separator outside of the pattern."};
+  }
+
+  for (size_t i = 0; i < cc_list.size(); ++i) {
+    auto& cc = cc_list[i];
+    std::string in, out;
+    for (unsigned c = 0; c < 256; ++c) {
+      auto printable = c >= 0x20 && c < 0x7f;
+      if (cc.match(static_cast<char>(c))) {
+        in.push_back(static_cast<char>(c));
+      } else if (printable && static_cast<char>(c) != separator_) {
+        out.push_back(static_cast<char>(c));
+      }
+    }
+    if (in.empty()) {
+      throw std::runtime_error{"the pattern contains an empty character class."};
+    }
+    members.push_back(std::move(in));
+    non_members.push_back(std::move(out));
+    if (cc.isStar()) {
+      max_line += this->options.max_repeat;
+    } else {
+      if (!non_members.back().empty()) {
+        breakable.push_back(i);
+      }
+      max_line += 1;
+    }
+  }
+}
+
+void InputGenerator::write_match(Random& random, std::string& line) const {
+  for (size_t i = 0; i < cc_list.size(); ++i) {
+    auto& chars = members[i];
+    auto count = cc_list[i].isStar() ? random.uniform(options.max_repeat + 1) : 1;
+    while (count--) {
+      line.push_back(chars[random.uniform(chars.size())]);
+    }
+  }
+}
+
+bool InputGenerator::write_miss(Random& random, std::string& line) const {
+  // prefer near misses: an instance of the pattern with one required character replaced
+  if (!breakable.empty()) {
+    auto broken = breakable[random.uniform(breakable.size())];
+    for (size_t i = 0; i < cc_list.size(); ++i) {
+      auto& chars = i == broken ? non_members[i] : members[i];
+      auto count = cc_list[i].isStar() ? random.uniform(options.max_repeat + 1) : 1;
+      while (count--) {
+        line.push_back(chars[random.uniform(chars.size())]);
+      }
+    }
+    return false;
+  }
+
+  // every match starts with the first character class, a line without it cannot match
+  auto& chars = non_members[0];
+  if (chars.empty()) {
+    write_match(random, line);
+    return true;
+  }
+  for (auto count = 1 + random.uniform(max_line - 1); count > 0; --count) {
+    line.push_back(chars[random.uniform(chars.size())]);
+  }
+  return false;
+}
+
+uint64_t InputGenerator::fill_chunk(uint64_t index, char* output, uint64_t size) const {
+  // every chunk has its own stream, so the output does not depend on the scheduling
+  Random random(options.seed ^ (index * 0xD1B54A32D192ED03ULL));
+  random.next();
+
+  uint64_t matches = 0;
+  uint64_t pos = 0;
+  std::string line;
+  line.reserve(max_line);
+  while (size - pos > max_line) {
+    line.clear();
+    if (random.chance(options.selectivity)) {
+      write_match(random, line);
+      ++matches;
+    } else if (write_miss(random, line)) {
+      ++matches;
+    }
+    line.push_back(separator_);
+    std::memcpy(output + pos, line.data(), line.size());
+    pos += line.size();
+  }
+  std::memset(output + pos, separator_, size - pos);
+  return matches;
+}
+
+template <typename Consumer>
+void InputGenerator::run(uint64_t size, Consumer&& consumer) {
+  auto total = output_size(size);
+  auto chunk_size = options.chunk_size;
+  auto chunks = (total + chunk_size - 1) / chunk_size;
+
+  std::atomic<uint64_t> next_chunk{0};
+  std::atomic<uint64_t> matches{0};
+  auto worker = [&](unsigned id) {
+    for (auto index = next_chunk++; index < chunks; index = next_chunk++) {
+      auto offset = index * chunk_size;
+      auto length = std::min(chunk_size, total - offset);
+      matches += consumer(id, index, offset, length);
+    }
+  };
+
+  auto threads = static_cast<unsigned>(std::min<uint64_t>(options.threads, std::max<uint64_t>(chunks, 1)));
+  std::vector<std::thread> workers;
+  for (unsigned id = 1; id < threads; ++id) {
+    workers.emplace_back(worker, id);
+  }
+  worker(0);
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  planted = matches;
+}
+
+std::string InputGenerator::generate(uint64_t size) {
+  std::string output(output_size(size), '\0');
+  run(size, [&](unsigned, uint64_t index, uint64_t offset, uint64_t length) {
+    return fill_chunk(index, output.data() + offset, length);
+  });
+  return output;
+}
+
+void InputGenerator::generate(uint64_t size, const char* path) {
+  auto fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error{std::string("cannot open ") + path};
+  }
+  if (::ftruncate(fd, static_cast<off_t>(output_size(size))) != 0) {
+    ::close(fd);
+    throw std::runtime_error{std::string("cannot resize ") + path};
+  }
+
+  std::vector<std::vector<char>> buffers(options.threads);
+  std::atomic<bool> failed{false};
+  run(size, [&](unsigned worker, uint64_t index, uint64_t offset, uint64_t length) {
+    auto& buffer = buffers[worker];
+    buffer.resize(options.chunk_size);
+    auto matches = fill_chunk(index, buffer.data(), length);
+    for (uint64_t written = 0; written < length && !failed;) {
+      auto result = ::pwrite(fd, buffer.data() + written, length - written, static_cast<off_t>(offset + written));
+      if (result <= 0) {
+        failed = true;
+        break;
+      }
+      written += static_cast<uint64_t>(result);
+    }
+    return matches;
+  });
+
+  if (::close(fd) != 0 || failed) {
+    throw std::runtime_error{std::string("cannot write ") + path};
+  }
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "io/read_ahead.h"
+
+namespace {
+
+const size_t BLOCK_SIZE = 63;
+
+} // namespace
+
+io::ReadAhead::ReadAhead(std::unique_ptr<Source> source, size_t buffer_size, size_t buffers)
+  : source(std::move(source))
+  , slots(std::max<size_t>(buffers, 2)) {
+  // the alignments are powers of two, so the block size times the alignment is a multiple of both
+  auto granularity = BLOCK_SIZE * this->source->alignment();
+  buffer_size = std::max(buffer_size / granularity, size_t{1}) * granularity;
+  for (auto& slot : slots) {
+    slot.data.resize(buffer_size);
+  }
+  thread = std::thread([this]() { produce(); });
+}
+
+io::ReadAhead::~ReadAhead() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  emptied.notify_all();
+  thread.join();
+}
+
+std::string_view io::ReadAhead::next() {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (holding) {
+    holding = false;
+    --used;
+    emptied.notify_one();
+  }
+  filled.wait(lock, [this]() { return ready > 0 || done; });
+  if (ready == 0) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return {};
+  }
+  auto& slot = slots[read_index];
+  read_index = (read_index + 1) % slots.size();
+  --ready;
+  holding = true;
+  return {slot.data.data(), slot.size};
+}
+
+void io::ReadAhead::produce() {
+  try {
+    for (size_t write_index = 0;; write_index = (write_index + 1) % slots.size()) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        emptied.wait(lock, [this]() { return used < slots.size() || stopping; });
+        if (stopping) {
+          return;
+        }
+      }
+
+      // fill the whole slot, short reads would leave partial blocks in the middle of the input
+      auto& slot = slots[write_index];
+      slot.size = 0;
+      for (size_t size = 1; size > 0 && slot.size < slot.data.size();) {
+        size = source->read(slot.data.data() + slot.size, slot.data.size() - slot.size);
+        slot.size += size;
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (slot.size > 0) {
+        ++ready;
+        ++used;
+      }
+      if (slot.size < slot.data.size()) {
+        done = true;
+      }
+      filled.notify_one();
+      if (done) {
+        return;
+      }
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex);
+    error = std::current_exception();
+    done = true;
+    filled.notify_one();
+  }
+}
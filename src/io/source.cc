@@ -0,0 +1,185 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#if ZSTD
+#include <zstd.h>
+#endif
+
+#include "io/source.h"
+
+namespace {
+
+enum class Format {
+  Plain,
+  Gzip,
+  Zstd,
+};
+
+Format detect(const std::string& path) {
+  std::array<unsigned char, 4> magic{};
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error{"cannot open " + path + ": " + std::strerror(errno)};
+  }
+  auto size = ::read(fd, magic.data(), magic.size());
+  ::close(fd);
+  if (size >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+    return Format::Gzip;
+  }
+  if (size >= 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+    return Format::Zstd;
+  }
+  return Format::Plain;
+}
+
+} // namespace
+
+io::FileSource::FileSource(const std::string& path)
+  : fd(::open(path.c_str(), O_RDONLY)) {
+  if (fd < 0) {
+    throw std::runtime_error{"cannot open " + path + ": " + std::strerror(errno)};
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+io::FileSource::~FileSource() {
+  ::close(fd);
+}
+
+size_t io::FileSource::read(char* buffer, size_t size) {
+  auto result = ::read(fd, buffer, size);
+  while (result < 0 && errno == EINTR) {
+    result = ::read(fd, buffer, size);
+  }
+  if (result < 0) {
+    throw std::runtime_error{std::string("read failed: ") + std::strerror(errno)};
+  }
+  return static_cast<size_t>(result);
+}
+
+io::DirectFileSource::DirectFileSource(const std::string& path)
+  : fd(::open(path.c_str(), O_RDONLY | O_DIRECT))
+  , direct_(true)
+  , offset(0) {
+  if (fd < 0 && errno == EINVAL) {
+    // e.g. tmpfs does not support O_DIRECT
+    fd = ::open(path.c_str(), O_RDONLY);
+    direct_ = false;
+  }
+  if (fd < 0) {
+    throw std::runtime_error{"cannot open " + path + ": " + std::strerror(errno)};
+  }
+}
+
+io::DirectFileSource::~DirectFileSource() {
+  ::close(fd);
+}
+
+size_t io::DirectFileSource::read(char* buffer, size_t size) {
+  for (;;) {
+    auto result = ::pread(fd, buffer, size, static_cast<off_t>(offset));
+    if (result >= 0) {
+      offset += static_cast<size_t>(result);
+      return static_cast<size_t>(result);
+    }
+    if (errno == EINVAL && direct_) {
+      // the device rejects the alignment, continue with buffered reads
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+      direct_ = false;
+    } else if (errno != EINTR) {
+      throw std::runtime_error{std::string("read failed: ") + std::strerror(errno)};
+    }
+  }
+}
+
+io::GzipSource::GzipSource(const std::string& path)
+  : file(gzopen(path.c_str(), "rb")) {
+  if (file == nullptr) {
+    throw std::runtime_error{"cannot open " + path};
+  }
+  // larger than the default 8 KB, the decompression is the bottleneck and not the reads
+  gzbuffer(static_cast<gzFile>(file), 1 << 17);
+}
+
+io::GzipSource::~GzipSource() {
+  gzclose(static_cast<gzFile>(file));
+}
+
+size_t io::GzipSource::read(char* buffer, size_t size) {
+  // gzread takes an unsigned length
+  auto result = gzread(static_cast<gzFile>(file), buffer, static_cast<unsigned>(std::min<size_t>(size, 1U << 30)));
+  if (result < 0) {
+    int error;
+    throw std::runtime_error{std::string("gzip decompression failed: ") + gzerror(static_cast<gzFile>(file), &error)};
+  }
+  return static_cast<size_t>(result);
+}
+
+#if ZSTD
+struct io::ZstdSource::State {
+  explicit State(const std::string& path)
+    : file(path)
+    , stream(ZSTD_createDStream())
+    , input(ZSTD_DStreamInSize())
+    , in{input.data(), 0, 0} {}
+
+  ~State() { ZSTD_freeDStream(stream); }
+
+  FileSource file;
+  ZSTD_DStream* stream;
+  std::vector<char> input;
+  ZSTD_inBuffer in;
+};
+
+io::ZstdSource::ZstdSource(const std::string& path)
+  : state(std::make_unique<State>(path)) {}
+
+io::ZstdSource::~ZstdSource() = default;
+
+size_t io::ZstdSource::read(char* buffer, size_t size) {
+  ZSTD_outBuffer out{buffer, size, 0};
+  while (out.pos < out.size) {
+    if (state->in.pos == state->in.size) {
+      state->in.size = state->file.read(state->input.data(), state->input.size());
+      state->in.pos = 0;
+      if (state->in.size == 0) {
+        break;
+      }
+    }
+    auto result = ZSTD_decompressStream(state->stream, &out, &state->in);
+    if (ZSTD_isError(result)) {
+      throw std::runtime_error{std::string("zstd decompression failed: ") + ZSTD_getErrorName(result)};
+    }
+  }
+  return out.pos;
+}
+#endif
+
+std::unique_ptr<io::Source> io::open(const std::string& path, bool direct) {
+  switch (detect(path)) {
+    case Format::Gzip:
+      return std::make_unique<GzipSource>(path);
+    case Format::Zstd:
+#if ZSTD
+      return std::make_unique<ZstdSource>(path);
+#else
+      throw std::runtime_error{path + " is zstd compressed, but the build has no zstd support"};
+#endif
+    case Format::Plain:
+      break;
+  }
+  if (direct) {
+    return std::make_unique<DirectFileSource>(path);
+  }
+  return std::make_unique<FileSource>(path);
+}
+
+bool io::is_compressed(const std::string& path) {
+  return detect(path) != Format::Plain;
+}
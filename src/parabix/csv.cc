@@ -0,0 +1,46 @@
+#include <wmmintrin.h>
+
+#include "parabix/csv.h"
+
+namespace {
+
+const uint64_t BLOCK_MASK = ~(1ULL << 63);
+
+// bit i of the result is the XOR of the bits 0..i, a carry-less multiplication with all ones
+uint64_t prefix_xor(uint64_t bits) {
+  auto product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(bits)), _mm_set1_epi8(-1), 0);
+  return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+}
+
+} // namespace
+
+parabix::CsvFields::CsvFields(unsigned field, Options options)
+  : field(field)
+  , options(options)
+  , inside_quotes(0)
+  , current(0)
+  , newlines_(0) {}
+
+uint64_t parabix::CsvFields::next(const std::array<uint64_t, 8>& basis) {
+  auto quoted = (prefix_xor(match_char(basis, options.quote)) ^ inside_quotes) & BLOCK_MASK;
+  inside_quotes = (quoted >> 62) & 1 ? ~0ULL : 0;
+
+  newlines_ = match_char(basis, '\n') & ~quoted;
+  auto separators = (match_char(basis, options.separator) & ~quoted) | newlines_;
+
+  // the field index only changes at the separators, the loop runs once per separator and not per position
+  uint64_t result = 0;
+  unsigned begin = 0;
+  for (; separators; separators &= separators - 1) {
+    auto end = static_cast<unsigned>(__builtin_ctzll(separators));
+    if (current == field) {
+      result |= ((1ULL << end) - 1) & ~((1ULL << begin) - 1);
+    }
+    current = (newlines_ >> end) & 1 ? 0 : current + 1;
+    begin = end + 1;
+  }
+  if (current == field) {
+    result |= BLOCK_MASK & ~((1ULL << begin) - 1);
+  }
+  return result;
+}
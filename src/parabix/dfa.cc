@@ -0,0 +1,86 @@
+#include "parabix/dfa.h"
+#include <stdexcept>
+
+using DFA = parabix::DFA;
+
+DFA::DFA(std::vector<parser::CC> cc_list)
+  : cc_list(std::move(cc_list))
+  , char_masks{}
+  , star_mask(0) {
+  if (this->cc_list.empty() || this->cc_list.size() > 63) {
+    throw std::runtime_error{"the DFA supports between 1 and 63 character classes."};
+  }
+  for (size_t i = 0; i < this->cc_list.size(); ++i) {
+    auto& cc = this->cc_list[i];
+    if (cc.isStar()) {
+      star_mask |= 1ULL << i;
+    }
+    for (unsigned c = 0; c < 256; ++c) {
+      if (cc.match(static_cast<char>(c))) {
+        char_masks[c] |= 1ULL << i;
+      }
+    }
+  }
+  intern(0);
+}
+
+DFA::StateSet DFA::closure(StateSet set) const {
+  // a star forwards its marker without consuming a character: marker[i + 1] |= marker[i]
+  for (size_t i = 0; i < cc_list.size(); ++i) {
+    if ((star_mask >> i) & (set >> i) & 1) {
+      set |= 1ULL << (i + 1);
+    }
+  }
+  return set;
+}
+
+uint32_t DFA::transition(uint32_t state, uint8_t c) {
+  auto& entry = table[state * 256 + c];
+  if (entry != UNKNOWN) {
+    return entry;
+  }
+
+  auto cc_size = cc_list.size();
+  auto mask = char_masks[c];
+  // the first marker stream is the first character class itself
+  auto set = closure(states[state] | (mask & 1));
+  auto accept = (set >> cc_size) & 1;
+
+  StateSet next = 0;
+  for (size_t i = 0; i < cc_size; ++i) {
+    if (!((mask >> i) & 1)) {
+      continue;
+    }
+    // advance consumes from marker[i], match star keeps consuming from marker[i + 1]
+    auto source = (star_mask >> i) & 1 ? i + 1 : i;
+    if ((set >> source) & 1) {
+      next |= 1ULL << (i + 1);
+    }
+  }
+
+  auto next_state = intern(next);
+  // the table may have been resized by intern
+  return table[state * 256 + c] = (next_state << 1) | static_cast<uint32_t>(accept);
+}
+
+uint32_t DFA::intern(StateSet set) {
+  auto [it, inserted] = state_ids.try_emplace(set, static_cast<uint32_t>(states.size()));
+  if (inserted) {
+    states.push_back(set);
+    table.resize(states.size() * 256, UNKNOWN);
+  }
+  return it->second;
+}
+
+uint64_t DFA::match(const char* input, size_t size) {
+  uint64_t matched = 0;
+  uint32_t state = 0;
+  for (size_t i = 0; i < size; ++i) {
+    auto entry = transition(state, static_cast<uint8_t>(input[i]));
+    matched += entry & 1;
+    state = entry >> 1;
+  }
+  // a match that ends with the last character is marked behind the input
+  matched += (closure(states[state]) >> cc_list.size()) & 1;
+  return matched;
+}
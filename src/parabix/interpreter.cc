@@ -0,0 +1,97 @@
+#include "parabix/interpreter.h"
+#include <popcntintrin.h>
+#include <algorithm>
+#include "codegen/cc_compiler.h"
+
+using Interpreter = parabix::Interpreter;
+using Bytecode = codegen::Bytecode;
+
+namespace {
+
+const size_t BLOCK_SIZE = 63;
+
+} // namespace
+
+Interpreter::Interpreter(std::vector<parser::CC> cc_list)
+  : cc_list(std::move(cc_list)) {
+  codegen::CCCompiler cc_compiler;
+  std::vector<std::unique_ptr<codegen::BitwiseExpression>> expressions;
+  for (auto& cc : this->cc_list) {
+    expressions.push_back(cc_compiler.compile(cc));
+  }
+  codegen::BytecodeCompiler bytecode_compiler;
+  bytecode = bytecode_compiler.compile(expressions);
+
+  registers.assign(bytecode.getRegisterCount() * Bytecode::BATCH, 0);
+  std::fill_n(registers.begin() + Bytecode::ONES * Bytecode::BATCH, Bytecode::BATCH, ~0ULL);
+  cc.assign(this->cc_list.size(), 0);
+  marker.assign(this->cc_list.size() + 1, 0);
+  carry.assign(this->cc_list.size(), 0);
+}
+
+bool Interpreter::run(const std::array<uint64_t, 8>& basis) {
+  evaluate(&basis, 1);
+  return step(0);
+}
+
+uint64_t Interpreter::run(const std::array<uint64_t, 8>* basis, size_t blocks, uint64_t& skipped) {
+  uint64_t matched = 0;
+  for (size_t first = 0; first < blocks; first += Bytecode::BATCH) {
+    auto count = std::min(Bytecode::BATCH, blocks - first);
+    evaluate(basis + first, count);
+    for (size_t block = 0; block < count; ++block) {
+      if (step(block)) {
+        ++skipped;
+        continue;
+      }
+      matched += _mm_popcnt_u64(marker.back());
+    }
+  }
+  return matched;
+}
+
+void Interpreter::evaluate(const std::array<uint64_t, 8>* basis, size_t blocks) {
+  // the basis bits of a block are a row, the registers columns
+  for (size_t block = 0; block < blocks; ++block) {
+    for (size_t bit = 0; bit < 8; ++bit) {
+      registers[bit * Bytecode::BATCH + block] = basis[block][bit];
+    }
+  }
+  bytecode.execute(registers.data());
+}
+
+bool Interpreter::step(size_t block) {
+  auto& outputs = bytecode.getOutputs();
+  // a block without a first character and without incoming carries cannot produce any marker
+  cc[0] = registers[outputs[0] * Bytecode::BATCH + block];
+  if (cc[0] == 0 && std::find(carry.begin(), carry.end(), 1) == carry.end()) {
+    return true;
+  }
+
+  for (size_t i = 1; i < cc_list.size(); ++i) {
+    cc[i] = registers[outputs[i] * Bytecode::BATCH + block];
+  }
+
+  marker[0] = cc[0];
+  for (size_t i = 0; i < cc_list.size(); ++i) {
+    if (cc_list[i].isStar()) {
+      auto M = marker[i];
+      M &= cc[i];
+      M += cc[i] + carry[i];
+      carry[i] = (M >> BLOCK_SIZE) & 1;
+      M &= ~(1ULL << BLOCK_SIZE);
+      M ^= cc[i];
+      M |= marker[i];
+      marker[i + 1] = M;
+    } else {
+      auto M = marker[i];
+      M &= cc[i];
+      M <<= 1;
+      M |= carry[i];
+      carry[i] = (M >> BLOCK_SIZE) & 1;
+      M &= ~(1ULL << BLOCK_SIZE);
+      marker[i + 1] = M;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,28 @@
+#include "parabix/literal.h"
+#include <immintrin.h>
+#include <cstring>
+
+uint64_t parabix::literal_count(const char* input, size_t size, std::string_view literal) {
+  auto length = literal.size();
+  if (length == 0 || length > size) {
+    return 0;
+  }
+  uint64_t matched = 0;
+  auto last = size - length;
+  size_t pos = 0;
+  const auto first_char = _mm256_set1_epi8(literal.front());
+  const auto last_char = _mm256_set1_epi8(literal.back());
+  for (; pos + 32 <= last + 1; pos += 32) {
+    auto first = _mm256_cmpeq_epi8(first_char, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + pos)));
+    auto end = _mm256_cmpeq_epi8(last_char, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + pos + length - 1)));
+    auto candidates = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(first, end)));
+    for (; candidates != 0; candidates &= candidates - 1) {
+      auto candidate = pos + __builtin_ctz(candidates);
+      matched += length <= 2 || std::memcmp(input + candidate + 1, literal.data() + 1, length - 2) == 0;
+    }
+  }
+  for (; pos <= last; ++pos) {
+    matched += std::memcmp(input + pos, literal.data(), length) == 0;
+  }
+  return matched;
+}
@@ -0,0 +1,502 @@
+#include <popcntintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "parabix/matcher.h"
+#include "parabix/bit.h"
+#include "parabix/telemetry.h"
+#include "parser/re_parser.h"
+#include "codegen/parabix_compiler.h"
+
+namespace {
+
+// number of blocks that are transposed at once, 256 * 8 basis words fit into L1
+const size_t CHUNK_BLOCKS = 256;
+
+const size_t BLOCK_SIZE = 63;
+
+const uint64_t BLOCK_MASK = ~(1ULL << BLOCK_SIZE);
+
+// the positions at and behind the end of the input within the block, they are record boundaries
+uint64_t input_end(size_t block, size_t size) {
+  auto begin = block * BLOCK_SIZE;
+  return begin + BLOCK_SIZE > size ? BLOCK_MASK & ~((1ULL << (size - begin)) - 1) : 0;
+}
+
+// set the bit of the record in the bitmap
+void set_bit(std::vector<uint8_t>& bitmap, uint64_t record) {
+  if (record / 8 >= bitmap.size()) {
+    bitmap.resize(record / 8 + 1);
+  }
+  bitmap[record / 8] |= 1 << (record % 8);
+}
+
+// the buffers are reused by all calls of the thread, whichever matcher they belong to
+parabix::Matcher::Scratch& thread_scratch() {
+  thread_local parabix::Matcher::Scratch scratch;
+  return scratch;
+}
+
+} // namespace
+
+parabix::Matcher::Matcher(const std::string& pattern)
+  : Matcher(pattern, Options{}) {}
+
+parabix::Matcher::Matcher(const std::string& pattern, Options options)
+  : Matcher(llvm::orc::ThreadSafeContext(std::make_unique<llvm::LLVMContext>()), pattern, options) {}
+
+parabix::Matcher::Matcher(llvm::orc::ThreadSafeContext context, const std::string& pattern, Options options)
+  : pattern(pattern)
+  , context(std::make_unique<llvm::orc::ThreadSafeContext>(std::move(context)))
+  , records(options.records || options.delimiter.has_value())
+  , delimiter(options.delimiter) {
+  Timer timer;
+  parser::ReParser parser;
+  cc_list = parser.parse(pattern.c_str());
+  statistics.parse_seconds = timer.reset();
+  if (!cc_list.empty() && cc_list.size() <= 63) {
+    spans.emplace(cc_list);
+  }
+
+  compiler = std::make_unique<codegen::ParabixCompiler>(*this->context, options.level);
+  std::optional<parser::CC> delimiter_cc;
+  if (delimiter) {
+    delimiter_cc.emplace(std::vector<std::pair<char, char>>{{*delimiter, *delimiter}});
+  }
+  compiler->compile(cc_list, options.verbose, records, delimiter_cc);
+
+  auto& compile_statistics = compiler->getStatistics();
+  statistics.cc_compile_seconds = compile_statistics.cc_compile_seconds;
+  statistics.ir_build_seconds = compile_statistics.ir_build_seconds;
+  statistics.optimize_seconds = compile_statistics.optimize_seconds;
+  statistics.codegen_seconds = compile_statistics.codegen_seconds;
+  statistics.code_size = compile_statistics.code_size;
+}
+
+parabix::Matcher::Matcher(Matcher&&) noexcept = default;
+
+parabix::Matcher& parabix::Matcher::operator=(Matcher&&) noexcept = default;
+
+parabix::Matcher::~Matcher() = default;
+
+void parabix::Matcher::reset(Scratch& scratch) const {
+  auto cc_size = cc_list.size();
+  // with records, the last carry belongs to the record scan, the last cc and marker hold the boundaries and hits
+  scratch.cc.assign(cc_size + 1, 0);
+  scratch.carry.assign(cc_size + 1, 0);
+  scratch.marker.assign(cc_size + 2, 0);
+  scratch.chunk.resize(CHUNK_BLOCKS);
+}
+
+uint64_t parabix::Matcher::match(const char* input, size_t size, Stats* stats) const {
+  return match(thread_scratch(), input, size, stats);
+}
+
+uint64_t parabix::Matcher::match(Scratch& scratch, const char* input, size_t size, Stats* stats) const {
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  reset(scratch);
+
+  Telemetry::Scope telemetry("parabix_llvm", pattern.c_str(), size);
+  // the blocks cover one position more than the input, the markers behind the last character
+  auto matched = run_blocks(scratch, input, size, size / BLOCK_SIZE + 1, st);
+  st.bytes_processed = size;
+  return matched;
+}
+
+uint64_t parabix::Matcher::run_blocks(Scratch& scratch, const char* input, size_t size, size_t blocks, Stats& stats, std::vector<uint64_t>* ends) const {
+  Timer timer;
+  auto final_marker = cc_list.size();
+  uint64_t matched = 0;
+  for (size_t block = 0; block < blocks;) {
+    auto count = std::min(CHUNK_BLOCKS, blocks - block);
+    transpose_blocks(input, size, block, count, scratch.chunk.data());
+    stats.transpose_seconds += timer.reset();
+
+    for (size_t c = 0; c < count; ++c, ++block) {
+      if (compiler->run(scratch.chunk[c].data(), scratch.cc.data(), scratch.marker.data(), scratch.carry.data())) {
+        ++stats.blocks_skipped;
+        continue;
+      }
+      matched += _mm_popcnt_u64(scratch.marker[final_marker]);
+      if (ends) {
+        for (auto marker = scratch.marker[final_marker]; marker != 0; marker &= marker - 1) {
+          ends->push_back(block * BLOCK_SIZE + __builtin_ctzll(marker));
+        }
+      }
+    }
+    stats.blocks_processed += count;
+    stats.kernel_seconds += timer.reset();
+  }
+  return matched;
+}
+
+parabix::Matcher::First parabix::Matcher::match_first(const char* input, size_t size, uint64_t limit, Stats* stats) const {
+  return match_first(thread_scratch(), input, size, limit, stats);
+}
+
+parabix::Matcher::First parabix::Matcher::match_first(Scratch& scratch, const char* input, size_t size, uint64_t limit, Stats* stats) const {
+  if (limit == 0) {
+    // reached before the first byte
+    return {0, 0};
+  }
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  reset(scratch);
+
+  Telemetry::Scope telemetry("parabix_llvm", pattern.c_str(), size);
+  Timer timer;
+  First first{0, size};
+  auto final_marker = cc_list.size();
+  auto blocks = size / BLOCK_SIZE + 1;
+  // the chunks grow from a single block, a match close to the start is found without transposing ahead
+  size_t chunk_blocks = 1;
+  for (size_t block = 0; block < blocks;) {
+    auto count = std::min(chunk_blocks, blocks - block);
+    chunk_blocks = std::min(chunk_blocks * 2, CHUNK_BLOCKS);
+    transpose_blocks(input, size, block, count, scratch.chunk.data());
+    st.transpose_seconds += timer.reset();
+
+    for (size_t c = 0; c < count; ++c, ++block) {
+      ++st.blocks_processed;
+      if (compiler->run(scratch.chunk[c].data(), scratch.cc.data(), scratch.marker.data(), scratch.carry.data())) {
+        ++st.blocks_skipped;
+        continue;
+      }
+      auto marker = scratch.marker[final_marker];
+      auto matched = static_cast<uint64_t>(_mm_popcnt_u64(marker));
+      if (first.matched + matched < limit) {
+        first.matched += matched;
+        continue;
+      }
+      // drop the markers behind the last counted one
+      for (; first.matched + 1 < limit; ++first.matched) {
+        marker &= marker - 1;
+      }
+      first.matched = limit;
+      first.offset = block * BLOCK_SIZE + __builtin_ctzll(marker);
+      st.kernel_seconds += timer.reset();
+      st.bytes_processed = std::min(size, (block + 1) * BLOCK_SIZE);
+      return first;
+    }
+    st.kernel_seconds += timer.reset();
+  }
+  st.bytes_processed = size;
+  return first;
+}
+
+std::vector<parabix::Span> parabix::Matcher::match_spans(const char* input, size_t size) const {
+  return match_spans(thread_scratch(), input, size);
+}
+
+const parabix::SpanFinder& parabix::Matcher::getSpanFinder() const {
+  if (!spans) {
+    throw std::runtime_error{"the spans support between 1 and 63 character classes."};
+  }
+  return *spans;
+}
+
+std::vector<parabix::Span> parabix::Matcher::match_spans(Scratch& scratch, const char* input, size_t size) const {
+  auto& finder = getSpanFinder();
+  Stats stats;
+  reset(scratch);
+  Telemetry::Scope telemetry("parabix_llvm", pattern.c_str(), size);
+  std::vector<uint64_t> ends;
+  run_blocks(scratch, input, size, size / BLOCK_SIZE + 1, stats, &ends);
+  return finder.select(input, size, ends);
+}
+
+uint64_t parabix::Matcher::match_parallel(const char* input, size_t size, ThreadPool& pool) const {
+  // a few segments per worker balance the load, tiny segments would not pay for the tasks
+  const size_t min_segment_blocks = 1 << 16;
+  auto blocks = size / BLOCK_SIZE + 1;
+  auto segments = std::min(pool.size() * 4, blocks / min_segment_blocks);
+  if (segments < 2) {
+    return match(input, size);
+  }
+
+  struct Segment {
+    size_t first_block;
+    size_t blocks;
+    uint64_t matched;
+    /// The carries at the end of the segment, with zero carries at its start.
+    std::vector<uint64_t> carry;
+  };
+  std::vector<Segment> parts(segments);
+  ThreadPool::Group group;
+  for (size_t i = 0; i < segments; ++i) {
+    auto& part = parts[i];
+    part.first_block = blocks * i / segments;
+    part.blocks = blocks * (i + 1) / segments - part.first_block;
+    pool.submit(group, [&, this]() {
+      auto& scratch = thread_scratch();
+      Stats stats;
+      reset(scratch);
+      auto offset = part.first_block * BLOCK_SIZE;
+      part.matched = run_blocks(scratch, input + offset, size - offset, part.blocks, stats);
+      part.carry = scratch.carry;
+    });
+  }
+  pool.wait(group);
+
+  // the carries are the whole state between blocks, two runs with equal carries continue identically
+  Scratch fresh;
+  Scratch carried;
+  uint64_t matched = parts[0].matched;
+  auto carry = parts[0].carry;
+  auto final_marker = cc_list.size();
+  for (size_t i = 1; i < segments; ++i) {
+    auto& part = parts[i];
+    matched += part.matched;
+    reset(fresh);
+    reset(carried);
+    carried.carry = carry;
+    auto offset = part.first_block * BLOCK_SIZE;
+    size_t block = 0;
+    while (block < part.blocks && fresh.carry != carried.carry) {
+      transpose_blocks(input + offset, size - offset, block, 1, fresh.chunk.data());
+      if (!compiler->run(fresh.chunk[0].data(), fresh.cc.data(), fresh.marker.data(), fresh.carry.data())) {
+        matched -= _mm_popcnt_u64(fresh.marker[final_marker]);
+      }
+      if (!compiler->run(fresh.chunk[0].data(), carried.cc.data(), carried.marker.data(), carried.carry.data())) {
+        matched += _mm_popcnt_u64(carried.marker[final_marker]);
+      }
+      ++block;
+    }
+    carry = block == part.blocks && fresh.carry != carried.carry ? carried.carry : part.carry;
+  }
+  return matched;
+}
+
+void parabix::Matcher::start(Scratch& scratch) const {
+  reset(scratch);
+  scratch.pending_size = 0;
+  scratch.position = 0;
+}
+
+void parabix::Matcher::start(Scratch& scratch, const std::vector<uint64_t>& carry) const {
+  if (carry.size() != cc_list.size()) {
+    throw std::runtime_error{"the stream needs one carry per character class."};
+  }
+  start(scratch);
+  std::copy(carry.begin(), carry.end(), scratch.carry.begin());
+}
+
+uint64_t parabix::Matcher::run_stream(Scratch& scratch, const char* input, size_t size, size_t blocks, Stats& stats, std::vector<uint64_t>* ends) const {
+  auto first_end = ends ? ends->size() : 0;
+  auto matched = run_blocks(scratch, input, size, blocks, stats, ends);
+  for (auto i = first_end; ends && i < ends->size(); ++i) {
+    (*ends)[i] += scratch.position;
+  }
+  scratch.position += blocks * BLOCK_SIZE;
+  return matched;
+}
+
+std::optional<uint64_t> parabix::Matcher::settled(const Scratch& scratch) const {
+  for (auto carry : scratch.carry) {
+    if (carry != 0) {
+      return std::nullopt;
+    }
+  }
+  return scratch.position;
+}
+
+uint64_t parabix::Matcher::feed(Scratch& scratch, const char* input, size_t size, Stats* stats, std::vector<uint64_t>* ends) const {
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  uint64_t matched = 0;
+  size_t pos = 0;
+  if (scratch.pending_size > 0) {
+    // complete the waiting block first
+    pos = std::min(BLOCK_SIZE - scratch.pending_size, size);
+    std::memcpy(scratch.pending.data() + scratch.pending_size, input, pos);
+    scratch.pending_size += pos;
+    if (scratch.pending_size < BLOCK_SIZE) {
+      return 0;
+    }
+    matched += run_stream(scratch, scratch.pending.data(), BLOCK_SIZE, 1, st, ends);
+    scratch.pending_size = 0;
+  }
+
+  auto blocks = (size - pos) / BLOCK_SIZE;
+  matched += run_stream(scratch, input + pos, size - pos, blocks, st, ends);
+  pos += blocks * BLOCK_SIZE;
+  scratch.pending_size = size - pos;
+  std::memcpy(scratch.pending.data(), input + pos, scratch.pending_size);
+  st.bytes_processed += size;
+  return matched;
+}
+
+uint64_t parabix::Matcher::finish(Scratch& scratch, Stats* stats, std::vector<uint64_t>* ends) const {
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  // the last block holds the waiting bytes and the position behind the last character
+  auto matched = run_stream(scratch, scratch.pending.data(), scratch.pending_size, 1, st, ends);
+  scratch.pending_size = 0;
+  return matched;
+}
+
+std::vector<uint8_t> parabix::Matcher::match_column(const int32_t* offsets, size_t rows, const char* data) const {
+  return match_rows(thread_scratch(), offsets, rows, data);
+}
+
+std::vector<uint8_t> parabix::Matcher::match_column(const int64_t* offsets, size_t rows, const char* data) const {
+  return match_rows(thread_scratch(), offsets, rows, data);
+}
+
+std::vector<uint8_t> parabix::Matcher::match_column(Scratch& scratch, const int32_t* offsets, size_t rows, const char* data) const {
+  return match_rows(scratch, offsets, rows, data);
+}
+
+std::vector<uint8_t> parabix::Matcher::match_column(Scratch& scratch, const int64_t* offsets, size_t rows, const char* data) const {
+  return match_rows(scratch, offsets, rows, data);
+}
+
+template <typename Offset>
+std::vector<uint8_t> parabix::Matcher::match_rows(Scratch& scratch, const Offset* offsets, size_t rows, const char* data) const {
+  if (!records || delimiter) {
+    throw std::runtime_error{"match_column requires a matcher compiled with records and without a delimiter."};
+  }
+  std::vector<uint8_t> bitmap((rows + 7) / 8);
+  if (rows == 0) {
+    return bitmap;
+  }
+
+  // pack the rows with a separator position behind each of them, the separators are the record boundaries
+  auto size = static_cast<size_t>(offsets[rows] - offsets[0]) + rows;
+  auto blocks = size / BLOCK_SIZE + 1;
+  scratch.packed.resize(size);
+  scratch.boundary.assign(blocks, 0);
+  auto* packed = scratch.packed.data();
+  for (size_t row = 0, pos = 0; row < rows; ++row) {
+    auto length = static_cast<size_t>(offsets[row + 1] - offsets[row]);
+    std::memcpy(packed + pos, data + offsets[row], length);
+    pos += length;
+    packed[pos] = 0;
+    scratch.boundary[pos / BLOCK_SIZE] |= 1ULL << (pos % BLOCK_SIZE);
+    ++pos;
+  }
+
+  reset(scratch);
+  auto hits = cc_list.size() + 1;
+  size_t row = 0;
+  Telemetry::Scope telemetry("parabix_column", pattern.c_str(), size);
+  for (size_t block = 0; block < blocks;) {
+    auto count = std::min(CHUNK_BLOCKS, blocks - block);
+    transpose_blocks(packed, size, block, count, scratch.chunk.data());
+
+    for (size_t c = 0; c < count; ++c, ++block) {
+      auto boundary = scratch.boundary[block];
+      if (!compiler->run(scratch.chunk[c].data(), scratch.cc.data(), scratch.marker.data(), scratch.carry.data(), boundary)) {
+        // a hit is the separator of a matching row, its row is the number of separators in front of it
+        for (auto word = scratch.marker[hits]; word; word &= word - 1) {
+          auto hit = row + _mm_popcnt_u64(boundary & ((1ULL << __builtin_ctzll(word)) - 1));
+          bitmap[hit / 8] |= 1 << (hit % 8);
+        }
+      }
+      row += _mm_popcnt_u64(boundary);
+    }
+  }
+  return bitmap;
+}
+
+parabix::Matcher::Records parabix::Matcher::match_records(const char* input, size_t size, Stats* stats) const {
+  return match_records(thread_scratch(), input, size, stats);
+}
+
+parabix::Matcher::Records parabix::Matcher::match_records(Scratch& scratch, const char* input, size_t size, Stats* stats) const {
+  if (!delimiter) {
+    throw std::runtime_error{"match_records requires a matcher compiled with a delimiter."};
+  }
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  reset(scratch);
+  Timer timer;
+
+  Records result;
+  auto boundaries = cc_list.size();
+  auto hits = cc_list.size() + 1;
+  Telemetry::Scope telemetry("parabix_records", pattern.c_str(), size);
+  for (size_t block = 0, blocks = size / BLOCK_SIZE + 1; block < blocks;) {
+    auto count = std::min(CHUNK_BLOCKS, blocks - block);
+    transpose_blocks(input, size, block, count, scratch.chunk.data());
+    st.transpose_seconds += timer.reset();
+
+    for (size_t c = 0; c < count; ++c, ++block) {
+      // the end of the input is a boundary, it ends the last record if its delimiter is missing
+      auto end = input_end(block, size);
+      if (!compiler->run(scratch.chunk[c].data(), scratch.cc.data(), scratch.marker.data(), scratch.carry.data(), end)) {
+        auto boundary = scratch.cc[boundaries];
+        for (auto word = scratch.marker[hits]; word; word &= word - 1) {
+          set_bit(result.bitmap, result.count + _mm_popcnt_u64(boundary & ((1ULL << __builtin_ctzll(word)) - 1)));
+          ++result.matched;
+        }
+      } else {
+        ++st.blocks_skipped;
+      }
+      result.count += _mm_popcnt_u64(scratch.cc[boundaries] & ~end);
+    }
+    st.blocks_processed += count;
+    st.kernel_seconds += timer.reset();
+  }
+  st.bytes_processed = size;
+  if (size > 0 && input[size - 1] != *delimiter) {
+    ++result.count;
+  }
+  result.bitmap.resize((result.count + 7) / 8);
+  return result;
+}
+
+parabix::Matcher::Records parabix::Matcher::match_field(const char* input, size_t size, unsigned field, CsvFields::Options options, Stats* stats) const {
+  return match_field(thread_scratch(), input, size, field, options, stats);
+}
+
+parabix::Matcher::Records parabix::Matcher::match_field(Scratch& scratch, const char* input, size_t size, unsigned field, CsvFields::Options options, Stats* stats) const {
+  if (!records || delimiter) {
+    throw std::runtime_error{"match_field requires a matcher compiled with records and without a delimiter."};
+  }
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  reset(scratch);
+  Timer timer;
+
+  Records result;
+  CsvFields fields(field, options);
+  auto hits = cc_list.size() + 1;
+  auto last_newline = false;
+  Telemetry::Scope telemetry("parabix_field", pattern.c_str(), size);
+  for (size_t block = 0, blocks = size / BLOCK_SIZE + 1; block < blocks;) {
+    auto count = std::min(CHUNK_BLOCKS, blocks - block);
+    transpose_blocks(input, size, block, count, scratch.chunk.data());
+    st.transpose_seconds += timer.reset();
+
+    for (size_t c = 0; c < count; ++c, ++block) {
+      // everything outside of the field is a boundary, the first boundary behind the field receives its hit
+      auto end = input_end(block, size);
+      auto boundary = (~fields.next(scratch.chunk[c]) & BLOCK_MASK) | end;
+      auto newlines = fields.newlines() & ~end;
+      if (!compiler->run(scratch.chunk[c].data(), scratch.cc.data(), scratch.marker.data(), scratch.carry.data(), boundary)) {
+        // the row of a hit is the number of newlines in front of it
+        for (auto word = scratch.marker[hits]; word; word &= word - 1) {
+          set_bit(result.bitmap, result.count + _mm_popcnt_u64(newlines & ((1ULL << __builtin_ctzll(word)) - 1)));
+          ++result.matched;
+        }
+      } else {
+        ++st.blocks_skipped;
+      }
+      result.count += _mm_popcnt_u64(newlines);
+      if (size > 0 && (size - 1) / BLOCK_SIZE == block) {
+        last_newline = (newlines >> ((size - 1) % BLOCK_SIZE)) & 1;
+      }
+    }
+    st.blocks_processed += count;
+    st.kernel_seconds += timer.reset();
+  }
+  st.bytes_processed = size;
+  if (size > 0 && !last_newline) {
+    ++result.count;
+  }
+  result.bitmap.resize((result.count + 7) / 8);
+  return result;
+}
@@ -1,13 +1,20 @@
 #include <iomanip>
 #include <iostream>
 #include <popcntintrin.h>
+#include <algorithm>
+#include <cstring>
 
 #include "parabix/parabix.h"
 #include "parabix/bit.h"
+#include "parabix/dfa.h"
+#include "parabix/interpreter.h"
+#include "parabix/literal.h"
+#include "parabix/matcher.h"
+#include "parabix/planner.h"
+#include "parabix/telemetry.h"
 #include "parser/re_parser.h"
-#include "codegen/cc_compiler.h"
-#include "codegen/expression_compiler_cpp.h"
-#include "codegen/parabix_compiler.h"
+#include "operations/lazy.h"
+#include "operations/marker.h"
 
 #ifndef PRINT
   #define PRINT false
@@ -24,7 +31,7 @@ void print_basis_table(std::array<uint64_t, 8>& arr, std::string_view name) {
   }
 }
 
-void print_table(std::vector<uint64_t>& stream, std::string_view name) {
+void print_table(const std::vector<uint64_t>& stream, std::string_view name) {
   for (auto& elem : stream) {
     std::cout << std::setw(4) << std::left << name;
     for (auto j = 0; j < 63; ++j) {
@@ -35,131 +42,164 @@ void print_table(std::vector<uint64_t>& stream, std::string_view name) {
 }
 #endif
 
-uint64_t parabix::parabix_cpp(std::string& input, const char* pattern) {
-  parser::ReParser parser;
-  codegen::CCCompiler cc_compiler;
+namespace {
+
+// number of blocks that are transposed at once, 256 * 8 basis words fit into L1
+const size_t CHUNK_BLOCKS = 256;
+
+// transpose the blocks starting with `first_block` into basis bit streams, returns the number of blocks.
+// The blocks cover one position more than the input, the markers behind the last character.
+size_t transpose_chunk(const char* input, size_t input_size, size_t first_block, std::vector<std::array<uint64_t, 8>>& chunk) {
+  auto blocks = input_size / 63 + 1;
+  auto count = std::min(chunk.size(), blocks - first_block);
+  parabix::transpose_blocks(input, input_size, first_block, count, chunk.data());
+  return count;
+}
 
+} // namespace
+
+uint64_t parabix::parabix_cpp(std::string& input, const char* pattern, Stats* stats) {
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  Timer timer;
+
+  parser::ReParser parser;
   auto cc_list = parser.parse(pattern);
   auto input_size = input.length();
-  auto cc_size = cc_list.size();
+  st.parse_seconds = timer.reset();
 
   size_t block_size = 63;
   uint64_t matched = 0;
-  std::vector<bool> carry(cc_size, false);
 
 #if PRINT
   std::cout << "    " << input << std::endl;
 #endif
 
-  std::vector<std::unique_ptr<codegen::BitwiseExpression>> expressions(cc_size);
-  for (auto i = 0; i < cc_size; ++i) {
-    expressions[i] = cc_compiler.compile(cc_list[i]);
-  }
+  Interpreter interpreter(cc_list);
+  st.cc_compile_seconds = timer.reset();
 
-  auto markers_size = cc_size + 1;
-  std::vector<uint64_t> cc(cc_size);
-  std::vector<uint64_t> marker(markers_size);
-  codegen::ExpressionCompilerCpp expr_compiler_cpp;
-  std::array<uint8_t, 64> output;
-  std::array<uint64_t, 8> basis;
-  for (size_t i = 0, block = 0; i < input_size; i += block_size, ++block) {
-#if PRINT
-    std::cout << "processing block " << block << std::endl;
-#endif
-    transpose_sse(input.data() + i, output.data());
-    
-    for (auto i = 0, j = 7; i < 8; ++i, --j) {
-       basis[i] = *reinterpret_cast<uint64_t*>(&output[static_cast<unsigned>(j * 8)]);
-       basis[i] &= ~(1ULL << block_size);
-    }
+  std::vector<std::array<uint64_t, 8>> chunk(CHUNK_BLOCKS);
+  Telemetry::Scope telemetry("parabix_cpp", pattern, input_size);
+  for (size_t block = 0, blocks = input_size / block_size + 1; block < blocks;) {
+    auto count = transpose_chunk(input.data(), input_size, block, chunk);
+    st.transpose_seconds += timer.reset();
 
 #if PRINT
-    print_basis_table(basis, "B");
-#endif
-
-    for (auto i = 0; i < cc_size; ++i) {
-      cc[i] = expr_compiler_cpp.execute(basis, expressions[i].get());
-    }
+    for (size_t c = 0; c < count; ++c, ++block) {
+      auto& basis = chunk[c];
+      std::cout << "processing block " << block << std::endl;
+      print_basis_table(basis, "B");
+
+      if (interpreter.run(basis)) {
+        ++st.blocks_skipped;
+        continue;
+      }
 
-#if PRINT
-    print_table(cc, "CC");
-#endif
+      print_table(interpreter.getCC(), "CC");
+      print_table(interpreter.getMarkers(), "M");
 
-    marker[0] = cc[0];
-    for (size_t i = 0; i < cc_size; ++i) {
-      if (cc_list[i].isStar()) {
-        auto M = marker[i];
-        M &= cc[i];
-        M += cc[i] + carry[i];
-        carry[i] = (M >> block_size) & 1;
-        M &= ~(1ULL << block_size);
-        M ^= cc[i];
-        M |= marker[i];
-        marker[i + 1] = M;
-      } else {
-        auto M = marker[i];
-        M &= cc[i];
-        M <<= 1;
-        M |= carry[i];
-        carry[i] = (M >> block_size) & 1;
-        M &= ~(1ULL << block_size);
-        marker[i + 1] = M;
-      }
+      matched += _mm_popcnt_u64(interpreter.getMarkers().back());
     }
-
-#if PRINT
-    print_table(marker, "M");
+#else
+    matched += interpreter.run(chunk.data(), count, st.blocks_skipped);
+    block += count;
 #endif
-
-    matched += _mm_popcnt_u64(marker.back());
+    st.blocks_processed += count;
+    st.kernel_seconds += timer.reset();
   }
+  st.bytes_processed = input_size;
 
   return matched;
 }
 
-uint64_t parabix::parabix_llvm(llvm::orc::ThreadSafeContext& context, std::string& input, const char* pattern, bool verbose) {
-  parser::ReParser parser;
+uint64_t parabix::parabix_llvm(llvm::orc::ThreadSafeContext& context, std::string& input, const char* pattern, bool verbose, codegen::OptimizationLevel level, Stats* stats) {
+  Matcher::Options options;
+  options.level = level;
+  options.verbose = verbose;
+  Matcher matcher(context, pattern, options);
+  if (stats) {
+    *stats = matcher.getStatistics();
+  }
+  return matcher.match(input.data(), input.length(), stats);
+}
 
+uint64_t parabix::parabix_planned(llvm::orc::ThreadSafeContext& context, std::string& input, const char* pattern, codegen::OptimizationLevel level, Stats* stats) {
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  Timer timer;
+  parser::ReParser parser;
   auto cc_list = parser.parse(pattern);
-  auto input_size = input.length();
-  auto cc_size = cc_list.size();
+  auto plan = parabix::plan(cc_list, input.size());
+  auto plan_seconds = timer.reset();
 
-  size_t block_size = 63;
+  st = {};
   uint64_t matched = 0;
+  switch (plan.engine) {
+    case Engine::Literal:
+      matched = literal_count(input.data(), input.size(), plan.literal);
+      st.kernel_seconds = timer.reset();
+      st.bytes_processed = input.size();
+      break;
+    case Engine::DFA: {
+      DFA dfa(cc_list);
+      matched = dfa.match(input.data(), input.size());
+      st.kernel_seconds = timer.reset();
+      st.bytes_processed = input.size();
+      break;
+    }
+    case Engine::Interpreter:
+      matched = parabix_cpp(input, pattern, &st);
+      break;
+    case Engine::JIT:
+      matched = parabix_llvm(context, input, pattern, false, level, &st);
+      break;
+  }
+  // the planner parsed the pattern as well
+  st.parse_seconds += plan_seconds;
+  st.plan = engine_name(plan.engine);
+  return matched;
+}
 
-#if PRINT
-  std::cout << "    " << input << std::endl;
-#endif
-
-  codegen::ParabixCompiler compiler(context);
-  compiler.compile(cc_list, verbose);
+uint64_t parabix::parabix_bit_stream(std::string& input, const char* pattern) {
+  parser::ReParser parser;
+  auto cc_list = parser.parse(pattern);
+  auto input_size = input.length();
+  auto cc_size = cc_list.size();
 
-  std::vector<uint64_t> cc(cc_size);
-  std::vector<uint64_t> carry(cc_size);
-  std::vector<uint64_t> marker(cc_size + 1);
-  std::array<uint8_t, 64> output;
-  std::array<uint64_t, 8> basis;
-  for (size_t i = 0, block = 0; i < input_size; i += block_size, ++block) {
-#if PRINT
-    std::cout << "processing block " << block << std::endl;
-#endif
-    transpose_sse(input.data() + i, output.data());
-    
-    for (auto i = 0, j = 7; i < 8; ++i, --j) {
-       basis[i] = *reinterpret_cast<uint64_t*>(&output[static_cast<unsigned>(j * 8)]);
-       basis[i] &= ~(1ULL << block_size);
+  // one position more than the input for the markers behind the last character
+  std::vector<stream::BitStream> cc_bit_streams(cc_size, stream::BitStream(input_size + 1));
+  for (size_t i = 0; i < input_size; ++i) {
+    for (size_t j = 0; j < cc_size; ++j) {
+      cc_bit_streams[j].set(i, cc_list[j].match(input[i]));
     }
+  }
 
-    compiler.run(basis.data(), cc.data(), marker.data(), carry.data());
+  std::vector<stream::BitStream> markers(cc_size + 1, stream::BitStream(input_size + 1));
+  markers[0] = cc_bit_streams[0];
+  for (size_t i = 0; i < cc_size; ++i) {
+    if (cc_list[i].isStar()) {
+      operation::marker::match_star(markers[i + 1], markers[i], cc_bit_streams[i]);
+    } else {
+      operation::marker::advance(markers[i + 1], markers[i], cc_bit_streams[i]);
+    }
+  }
+  return markers.back().pop_count();
+}
 
-#if PRINT
-    print_basis_table(basis, "B");
-    print_table(cc, "CC");
-    print_table(marker, "M");
-#endif
+uint64_t parabix::parabix_fused(std::string& input, const char* pattern) {
+  parser::ReParser parser;
+  auto cc_list = parser.parse(pattern);
+  auto input_size = input.length();
 
-    matched += _mm_popcnt_u64(marker.back());
+  auto cc_stream = [&](size_t i) { return operation::lazy::chars(input.data(), input_size, cc_list[i]); };
+  auto marker = operation::lazy::erase(cc_stream(0));
+  for (size_t i = 0; i < cc_list.size(); ++i) {
+    if (cc_list[i].isStar()) {
+      marker = operation::lazy::erase(operation::lazy::match_star(std::move(marker), cc_stream(i)));
+    } else {
+      marker = operation::lazy::erase(operation::lazy::advance(std::move(marker), cc_stream(i)));
+    }
   }
-
-  return matched;
+  // one position more than the input for the markers behind the last character
+  return operation::lazy::pop_count(marker, input_size / 63 + 1);
 }
@@ -0,0 +1,95 @@
+#include "parabix/planner.h"
+#include "codegen/cc_compiler.h"
+
+namespace {
+
+// the estimates of the engines, measured with the benchmark on random inputs
+const double LITERAL_SECONDS_PER_BYTE = 0.1e-9;
+const double DFA_SECONDS_PER_BYTE = 3.7e-9;
+const double INTERPRETER_COMPILE_SECONDS = 30e-6;
+const double INTERPRETER_SECONDS_PER_BYTE = 0.6e-9;
+const double INTERPRETER_SECONDS_PER_OPERATION_BYTE = 0.005e-9;
+const double JIT_COMPILE_SECONDS = 8e-3;
+const double JIT_COMPILE_SECONDS_PER_OPERATION = 50e-6;
+const double JIT_SECONDS_PER_BYTE = 0.45e-9;
+const double JIT_SECONDS_PER_OPERATION_BYTE = 0.0035e-9;
+// longer patterns may have too many DFA states
+const size_t DFA_MAX_CC = 12;
+
+size_t count_operations(const codegen::BitwiseExpression* expression) {
+  switch (expression->getType()) {
+    case codegen::BitwiseExpression::Type::And:
+    case codegen::BitwiseExpression::Type::Or: {
+      auto* binary = static_cast<const codegen::BinaryExpression*>(expression);
+      return 1 + count_operations(binary->left.get()) + count_operations(binary->right.get());
+    }
+    case codegen::BitwiseExpression::Type::Not:
+      return 1 + count_operations(static_cast<const codegen::NotExpression*>(expression)->child.get());
+    case codegen::BitwiseExpression::Type::Selection: {
+      // (if & true) | (~if & false)
+      auto* selection = static_cast<const codegen::SelectionExpression*>(expression);
+      return 4 + count_operations(selection->if_expr.get()) + count_operations(selection->true_expr.get()) +
+             count_operations(selection->false_expr.get());
+    }
+    default:
+      return 0;
+  }
+}
+
+} // namespace
+
+const char* parabix::engine_name(Engine engine) {
+  switch (engine) {
+    case Engine::Literal:
+      return "literal";
+    case Engine::DFA:
+      return "DFA";
+    case Engine::Interpreter:
+      return "parabix-cpp";
+    case Engine::JIT:
+      return "parabix-llvm";
+  }
+  return "unknown";
+}
+
+parabix::Plan parabix::plan(const std::vector<parser::CC>& cc_list, size_t input_size) {
+  Plan plan;
+  auto literal = !cc_list.empty();
+  codegen::CCCompiler cc_compiler;
+  for (auto& cc : cc_list) {
+    auto ranges = cc.getRanges();
+    // the padding behind the input is zero, a zero character could match there
+    if (cc.isStar() || ranges.size() != 1 || ranges[0].first != ranges[0].second || ranges[0].first == '\0') {
+      literal = false;
+    } else {
+      plan.literal += ranges[0].first;
+    }
+    plan.operations += count_operations(cc_compiler.compile(cc).get());
+  }
+  // every engine that can run the pattern is a candidate, the cheapest estimate wins
+  auto bytes = static_cast<double>(input_size);
+  auto operations = static_cast<double>(plan.operations);
+  auto choose = [&plan](Engine engine, double seconds) {
+    if (seconds < plan.estimated_seconds) {
+      plan.engine = engine;
+      plan.estimated_seconds = seconds;
+    }
+  };
+  plan.engine = Engine::JIT;
+  plan.estimated_seconds = JIT_COMPILE_SECONDS + operations * JIT_COMPILE_SECONDS_PER_OPERATION +
+                           bytes * (JIT_SECONDS_PER_BYTE + operations * JIT_SECONDS_PER_OPERATION_BYTE);
+  // the interpreter compiles the expressions into bytecode and evaluates them per batch of blocks
+  choose(Engine::Interpreter, INTERPRETER_COMPILE_SECONDS +
+                              bytes * (INTERPRETER_SECONDS_PER_BYTE + operations * INTERPRETER_SECONDS_PER_OPERATION_BYTE));
+  // the DFA does one table lookup per byte
+  if (cc_list.size() <= DFA_MAX_CC) {
+    choose(Engine::DFA, bytes * DFA_SECONDS_PER_BYTE);
+  }
+  if (literal) {
+    choose(Engine::Literal, bytes * LITERAL_SECONDS_PER_BYTE);
+  }
+  if (plan.engine != Engine::Literal) {
+    plan.literal.clear();
+  }
+  return plan;
+}
@@ -0,0 +1,108 @@
+#include "parabix/replace.h"
+#include <algorithm>
+
+using Replacer = parabix::Replacer;
+
+Replacer::Replacer(const Matcher& matcher, const std::string& replacement, Writer writer)
+  : matcher(matcher)
+  , finder(matcher.getSpanFinder())
+  , writer(std::move(writer)) {
+  Piece literal{"", false};
+  for (size_t i = 0; i < replacement.size(); ++i) {
+    auto c = replacement[i];
+    if (c == '\\' && i + 1 < replacement.size() && (replacement[i + 1] == '&' || replacement[i + 1] == '\\')) {
+      literal.text += replacement[++i];
+    } else if (c == '&') {
+      if (!literal.text.empty()) {
+        this->replacement.push_back(std::move(literal));
+        literal = {"", false};
+      }
+      this->replacement.push_back({"", true});
+    } else {
+      literal.text += c;
+    }
+  }
+  if (!literal.text.empty()) {
+    this->replacement.push_back(std::move(literal));
+  }
+  matcher.start(scratch);
+}
+
+uint64_t Replacer::feed(const char* input, size_t size) {
+  buffer.append(input, size);
+  matcher.feed(scratch, input, size, nullptr, &ends);
+  resolve(false, matcher.settled(scratch).value_or(written));
+  return replaced;
+}
+
+uint64_t Replacer::finish() {
+  matcher.finish(scratch, nullptr, &ends);
+  resolve(true, buffer_begin + buffer.size());
+  return replaced;
+}
+
+void Replacer::resolve(bool final, uint64_t limit) {
+  auto stream_end = buffer_begin + buffer.size();
+  auto add = [this](std::string_view piece) {
+    if (!piece.empty()) {
+      pieces.push_back(piece);
+    }
+  };
+
+  pieces.clear();
+  for (; next_end < ends.size(); ++next_end) {
+    auto end = ends[next_end];
+    if (end < search || end > stream_end) {
+      continue;
+    }
+    auto start = finder.leftmost_start(buffer.data(), buffer.size(), end - buffer_begin, search - buffer_begin);
+    if (!start) {
+      continue;
+    }
+    auto incomplete = false;
+    auto longest = finder.longest_end(buffer.data(), buffer.size(), *start, final ? nullptr : &incomplete);
+    if (incomplete) {
+      // the match may grow with the next part
+      limit = std::min(limit, buffer_begin + *start);
+      break;
+    }
+    auto match_begin = buffer_begin + *start;
+    auto match_end = buffer_begin + longest.value_or(end - buffer_begin);
+    add(view(written, match_begin));
+    for (auto& piece : replacement) {
+      add(piece.match ? view(match_begin, match_end) : std::string_view(piece.text));
+    }
+    ++replaced;
+    written = match_end;
+    search = match_end > match_begin ? match_end : match_end + 1;
+  }
+  ends.erase(ends.begin(), ends.begin() + next_end);
+  next_end = 0;
+
+  if (limit > written) {
+    // no match starts in front of the limit
+    add(view(written, limit));
+    written = limit;
+    search = std::max(search, limit);
+  }
+  if (!pieces.empty()) {
+    writer(pieces);
+  }
+  // drop the written bytes once they are the larger part of the buffer
+  if (written - buffer_begin >= buffer.size() / 2) {
+    buffer.erase(0, written - buffer_begin);
+    buffer_begin = written;
+  }
+}
+
+std::string parabix::replace(const Matcher& matcher, const char* input, size_t size, const std::string& replacement) {
+  std::string result;
+  Replacer replacer(matcher, replacement, [&result](const std::vector<std::string_view>& pieces) {
+    for (auto piece : pieces) {
+      result.append(piece);
+    }
+  });
+  replacer.feed(input, size);
+  replacer.finish();
+  return result;
+}
@@ -0,0 +1,105 @@
+#include "parabix/span.h"
+#include <stdexcept>
+
+using SpanFinder = parabix::SpanFinder;
+
+SpanFinder::SpanFinder(std::vector<parser::CC> cc_list)
+  : cc_size(cc_list.size())
+  , char_masks{}
+  , star_mask(0) {
+  if (cc_list.empty() || cc_list.size() > 63) {
+    throw std::runtime_error{"the spans support between 1 and 63 character classes."};
+  }
+  for (size_t i = 0; i < cc_list.size(); ++i) {
+    auto& cc = cc_list[i];
+    if (cc.isStar()) {
+      star_mask |= 1ULL << i;
+    }
+    for (unsigned c = 0; c < 256; ++c) {
+      if (cc.match(static_cast<char>(c))) {
+        char_masks[c] |= 1ULL << i;
+      }
+    }
+  }
+}
+
+std::vector<parabix::Span> SpanFinder::select(const char* input, size_t size, const std::vector<uint64_t>& ends) const {
+  std::vector<Span> spans;
+  size_t pos = 0;
+  for (auto end : ends) {
+    if (end < pos || end > size) {
+      continue;
+    }
+    // an end without a start behind the previous match belongs to an overlapping match
+    auto start = leftmost_start(input, size, end, pos);
+    if (!start) {
+      continue;
+    }
+    auto longest = longest_end(input, size, *start).value_or(end);
+    spans.push_back({*start, longest});
+    // the next match may not be empty at the same position
+    pos = longest > *start ? longest : longest + 1;
+  }
+  return spans;
+}
+
+std::optional<size_t> SpanFinder::leftmost_start(const char* input, size_t size, size_t end, size_t begin) const {
+  auto closure = [this](uint64_t set) {
+    // a star forwards its marker without consuming a character, backwards: marker[i] |= marker[i + 1]
+    for (auto next = set | ((set >> 1) & star_mask); next != set; next = set | ((set >> 1) & star_mask)) {
+      set = next;
+    }
+    return set;
+  };
+
+  std::optional<size_t> start;
+  auto set = closure(1ULL << cc_size);
+  for (auto pos = end;; --pos) {
+    // the first character class has to match at the start, also if it is a star
+    if ((set & 1) && (char_mask(input, size, pos) & 1)) {
+      start = pos;
+    }
+    if (pos == begin) {
+      break;
+    }
+    auto mask = char_mask(input, size, pos - 1);
+    set = closure(((set >> 1) & ~star_mask & mask) | (set & ((star_mask & mask) << 1)));
+    if (set == 0) {
+      break;
+    }
+  }
+  return start;
+}
+
+std::optional<size_t> SpanFinder::longest_end(const char* input, size_t size, size_t start, bool* incomplete) const {
+  auto closure = [this](uint64_t set) {
+    for (auto next = set | ((set & star_mask) << 1); next != set; next = set | ((set & star_mask) << 1)) {
+      set = next;
+    }
+    return set;
+  };
+
+  if (!(char_mask(input, size, start) & 1)) {
+    return std::nullopt;
+  }
+  std::optional<size_t> end;
+  auto set = closure(1);
+  for (auto pos = start;; ++pos) {
+    if ((set >> cc_size) & 1) {
+      end = pos;
+    }
+    if (pos == size) {
+      if (incomplete) {
+        *incomplete = true;
+      }
+      break;
+    }
+    auto mask = char_mask(input, size, pos);
+    // advance consumes from marker[i], match star keeps consuming from marker[i + 1]
+    set = closure(((set & ~star_mask & mask) << 1) | (set & ((star_mask & mask) << 1)));
+    if (set == 0) {
+      break;
+    }
+  }
+  return end;
+}
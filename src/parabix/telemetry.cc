@@ -0,0 +1,153 @@
+#include "parabix/telemetry.h"
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include "PerfEvent.hpp"
+
+using Telemetry = parabix::Telemetry;
+using CounterRecord = parabix::CounterRecord;
+
+std::atomic<Telemetry*> Telemetry::installed_{nullptr};
+
+namespace {
+
+// the counters are opened once per thread and reused by every scan of that thread
+PerfEvent& thread_counters() {
+  static thread_local PerfEvent counters;
+  return counters;
+}
+
+// nested scopes on the same thread are measured by the outermost one
+thread_local bool measuring = false;
+
+void write_string(std::ostream& os, const std::string& value) {
+  os << '"';
+  for (auto c : value) {
+    switch (c) {
+      case '"': os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\t': os << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+} // namespace
+
+CounterRecord& CounterRecord::operator+=(const CounterRecord& other) {
+  scans += other.scans;
+  bytes += other.bytes;
+  seconds += other.seconds;
+  cycles += other.cycles;
+  instructions += other.instructions;
+  l1_misses += other.l1_misses;
+  llc_misses += other.llc_misses;
+  branch_misses += other.branch_misses;
+  counters_available = counters_available && other.counters_available;
+  return *this;
+}
+
+void CounterRecord::writeJson(std::ostream& os) const {
+  std::stringstream out;
+  out << std::setprecision(6);
+  out << "{\"engine\":";
+  write_string(out, engine);
+  out << ",\"pattern\":";
+  write_string(out, pattern);
+  out << ",\"thread\":" << std::hash<std::thread::id>{}(thread);
+  out << ",\"scans\":" << scans;
+  out << ",\"bytes\":" << bytes;
+  out << ",\"seconds\":" << seconds;
+  out << ",\"counters\":" << (counters_available ? "true" : "false");
+  if (counters_available) {
+    out << ",\"cycles\":" << cycles;
+    out << ",\"instructions\":" << instructions;
+    out << ",\"ipc\":" << ipc();
+    out << ",\"l1_misses\":" << l1_misses;
+    out << ",\"llc_misses\":" << llc_misses;
+    out << ",\"branch_misses\":" << branch_misses;
+    if (bytes > 0) {
+      auto n = static_cast<double>(bytes);
+      out << ",\"cycles_per_byte\":" << cycles / n;
+      out << ",\"instructions_per_byte\":" << instructions / n;
+      out << ",\"l1_misses_per_byte\":" << l1_misses / n;
+      out << ",\"llc_misses_per_byte\":" << llc_misses / n;
+      out << ",\"branch_misses_per_byte\":" << branch_misses / n;
+    }
+  }
+  out << "}\n";
+  os << out.str();
+}
+
+Telemetry::Scope::Scope(const char* engine, const char* pattern, uint64_t bytes)
+  : telemetry(measuring ? nullptr : installed())
+  , engine(engine)
+  , pattern(pattern)
+  , bytes(bytes) {
+  if (telemetry) {
+    measuring = true;
+    thread_counters().startCounters();
+  }
+}
+
+Telemetry::Scope::~Scope() {
+  if (!telemetry) {
+    return;
+  }
+  auto& counters = thread_counters();
+  counters.stopCounters();
+  measuring = false;
+
+  CounterRecord record;
+  record.engine = engine;
+  record.pattern = pattern;
+  record.thread = std::this_thread::get_id();
+  record.scans = 1;
+  record.bytes = bytes;
+  record.seconds = counters.getDuration();
+  // PerfEvent reports -1 for counters it could not open
+  record.cycles = counters.getCounter("cycles");
+  record.instructions = counters.getCounter("instructions");
+  record.l1_misses = counters.getCounter("L1-misses");
+  record.llc_misses = counters.getCounter("LLC-misses");
+  record.branch_misses = counters.getCounter("branch-misses");
+  record.counters_available = record.cycles >= 0 && record.instructions >= 0;
+  telemetry->record(record);
+}
+
+void Telemetry::record(const CounterRecord& record) {
+  std::lock_guard<std::mutex> lock(mutex);
+  record.writeJson(output);
+
+  auto [it, inserted] = totals.try_emplace(record.thread);
+  auto& total = it->second;
+  if (inserted) {
+    total.engine = "thread";
+    total.thread = record.thread;
+  }
+  total += record;
+}
+
+std::vector<CounterRecord> Telemetry::threadTotals() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<CounterRecord> result;
+  result.reserve(totals.size());
+  for (auto& [thread, total] : totals) {
+    result.push_back(total);
+  }
+  return result;
+}
+
+void Telemetry::writeThreadTotals() {
+  for (auto& total : threadTotals()) {
+    std::lock_guard<std::mutex> lock(mutex);
+    total.writeJson(output);
+  }
+}
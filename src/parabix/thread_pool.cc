@@ -0,0 +1,110 @@
+#include <algorithm>
+
+#include "parabix/thread_pool.h"
+
+namespace {
+
+// the pool and queue index of the calling worker, other threads have no queue
+thread_local const parabix::ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
+parabix::ThreadPool::ThreadPool(unsigned threads) {
+  threads = std::max(threads, 1U);
+  for (unsigned i = 0; i < threads; ++i) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+  for (unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back([this, i]() { work(i); });
+  }
+}
+
+parabix::ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wakeup.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void parabix::ThreadPool::submit(Group& group, std::function<void()> task) {
+  group.pending.fetch_add(1);
+  auto index = current_pool == this ? current_queue : next_queue.fetch_add(1) % queues.size();
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    queues[index]->tasks.push_back({&group, std::move(task)});
+  }
+  {
+    // under the lock, a worker that just found no task is either waiting already or sees the count
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.fetch_add(1);
+  }
+  wakeup.notify_one();
+  progress.notify_all();
+}
+
+void parabix::ThreadPool::wait(Group& group) {
+  auto self = current_pool == this ? current_queue : next_queue.load() % queues.size();
+  while (group.pending.load() > 0) {
+    if (run_one(self)) {
+      continue;
+    }
+    // the remaining tasks of the group run elsewhere, sleep until one finishes or new work arrives
+    std::unique_lock<std::mutex> lock(mutex);
+    progress.wait(lock, [&]() { return group.pending.load() == 0 || queued.load() > 0; });
+  }
+}
+
+bool parabix::ThreadPool::run_one(size_t self) {
+  Task task;
+  auto found = false;
+  {
+    // own queue, newest first
+    std::lock_guard<std::mutex> lock(queues[self]->mutex);
+    if (!queues[self]->tasks.empty()) {
+      task = std::move(queues[self]->tasks.back());
+      queues[self]->tasks.pop_back();
+      found = true;
+    }
+  }
+  for (size_t i = 1; !found && i < queues.size(); ++i) {
+    // steal the oldest task of another queue
+    auto& victim = *queues[(self + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+  queued.fetch_sub(1);
+  task.function();
+  if (task.group->pending.fetch_sub(1) == 1) {
+    // under the lock, a waiter that just checked the count is either waiting already or sees it
+    std::lock_guard<std::mutex> lock(mutex);
+    progress.notify_all();
+  }
+  return true;
+}
+
+void parabix::ThreadPool::work(size_t self) {
+  current_pool = this;
+  current_queue = self;
+  for (;;) {
+    if (run_one(self)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    wakeup.wait(lock, [this]() { return queued.load() > 0 || stopping; });
+    if (stopping && queued.load() == 0) {
+      return;
+    }
+  }
+}
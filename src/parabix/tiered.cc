@@ -0,0 +1,77 @@
+#include "parabix/tiered.h"
+#include <algorithm>
+#include <stdexcept>
+
+#include "parabix/bit.h"
+#include "parabix/interpreter.h"
+#include "parabix/telemetry.h"
+#include "parser/re_parser.h"
+
+using TieredMatcher = parabix::TieredMatcher;
+
+namespace {
+
+const size_t BLOCK_SIZE = 63;
+// number of blocks that are interpreted between two checks for the compiled kernel
+const size_t CHUNK_BLOCKS = 256;
+
+} // namespace
+
+TieredMatcher::TieredMatcher(const std::string& pattern, Matcher::Options options)
+  : pattern(pattern) {
+  if (options.records || options.delimiter) {
+    // the interpreter knows no record boundaries, the count would depend on when the kernel takes over
+    throw std::runtime_error{"the tiered matcher does not support records."};
+  }
+  parser::ReParser parser;
+  cc_list = parser.parse(pattern.c_str());
+  compilation = std::async(std::launch::async, [this, options]() {
+    try {
+      matcher = std::make_unique<Matcher>(this->pattern, options);
+      ready.store(true, std::memory_order_release);
+    } catch (const std::exception&) {
+      // the calls keep interpreting
+    }
+  }).share();
+}
+
+TieredMatcher::~TieredMatcher() {
+  compilation.wait();
+}
+
+uint64_t TieredMatcher::match(const char* input, size_t size, Stats* stats) const {
+  if (compiled()) {
+    return matcher->match(input, size, stats);
+  }
+  Stats local_stats;
+  auto& st = stats ? *stats : local_stats;
+  Timer timer;
+  Telemetry::Scope telemetry("parabix_tiered", pattern.c_str(), size);
+
+  Interpreter interpreter(cc_list);
+  std::vector<std::array<uint64_t, 8>> chunk(CHUNK_BLOCKS);
+  uint64_t matched = 0;
+  size_t block = 0;
+  auto blocks = size / BLOCK_SIZE + 1;
+  while (block < blocks && !compiled()) {
+    auto count = std::min(CHUNK_BLOCKS, blocks - block);
+    transpose_blocks(input, size, block, count, chunk.data());
+    st.transpose_seconds += timer.reset();
+    matched += interpreter.run(chunk.data(), count, st.blocks_skipped);
+    block += count;
+    st.blocks_processed += count;
+    st.blocks_interpreted += count;
+    st.kernel_seconds += timer.reset();
+  }
+
+  if (block < blocks) {
+    // the compiled kernel continues with the carries of the interpreter
+    Matcher::Scratch scratch;
+    matcher->start(scratch, interpreter.getCarries());
+    auto offset = block * BLOCK_SIZE;
+    matched += matcher->feed(scratch, input + offset, size - offset, &st);
+    matched += matcher->finish(scratch, &st);
+  }
+  st.bytes_processed = size;
+  return matched;
+}
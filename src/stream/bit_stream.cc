@@ -1,94 +1,326 @@
 #include "stream/bit_stream.h"
+#include <algorithm>
 #include <cassert>
+#include <thread>
+#include <unistd.h>
 
 using BitStream = stream::BitStream;
 
-BitStream BitStream::operator&(const BitStream& other) const {
-  BitStream result(*this);
-  return result &= other;
-}
+namespace {
 
-BitStream BitStream::operator|(const BitStream& other) const {
-  BitStream result(*this);
-  return result |= other;
-}
+using block_type = uint64_t;
 
-BitStream BitStream::operator^(const BitStream& other) const {
-  BitStream result(*this);
-  return result ^= other;
-}
+// every block stores 63 bits, the most significant bit is always clear
+const block_type BLOCK_MASK = ~(1ULL << 63);
 
-BitStream BitStream::operator+(const BitStream& other) const {
-  BitStream result(*this);
-  return result += other;
-}
+struct And {
+  static block_type apply(block_type a, block_type b) { return a & b; }
+  static __m256i apply(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#ifdef __AVX512F__
+  static __m512i apply(__m512i a, __m512i b) { return _mm512_and_si512(a, b); }
+#endif
+};
 
-BitStream BitStream::operator>>(const size_t offset) const {
-  BitStream result(*this);
-  return result >>= offset;
-}
+struct Or {
+  static block_type apply(block_type a, block_type b) { return a | b; }
+  static __m256i apply(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#ifdef __AVX512F__
+  static __m512i apply(__m512i a, __m512i b) { return _mm512_or_si512(a, b); }
+#endif
+};
 
-BitStream BitStream::operator~() const {
-  BitStream result(*this);
-  for (auto i = 0; i < blocks.size(); ++i) {
-    result.blocks[i] = ~blocks[i];
+struct Xor {
+  static block_type apply(block_type a, block_type b) { return a ^ b; }
+  static __m256i apply(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#ifdef __AVX512F__
+  static __m512i apply(__m512i a, __m512i b) { return _mm512_xor_si512(a, b); }
+#endif
+};
+
+struct AndNot {
+  static block_type apply(block_type a, block_type b) { return a & ~b; }
+  static __m256i apply(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+#ifdef __AVX512F__
+  static __m512i apply(__m512i a, __m512i b) { return _mm512_andnot_si512(b, a); }
+#endif
+};
+
+// the second operand is the block mask
+struct Not {
+  static block_type apply(block_type a, block_type) { return a ^ BLOCK_MASK; }
+  static __m256i apply(__m256i a, __m256i) { return _mm256_xor_si256(a, _mm256_set1_epi64x(static_cast<int64_t>(BLOCK_MASK))); }
+#ifdef __AVX512F__
+  static __m512i apply(__m512i a, __m512i) { return _mm512_xor_si512(a, _mm512_set1_epi64(static_cast<int64_t>(BLOCK_MASK))); }
+#endif
+};
+
+// dst[i] = Op(a[i], b[i]), the pointers may alias since every block is read before it is written
+template <typename Op>
+void transform(block_type* dst, const block_type* a, const block_type* b, size_t n, bool streaming) {
+  size_t i = 0;
+#ifdef __AVX512F__
+  for (; i + 8 <= n; i += 8) {
+    auto result = Op::apply(_mm512_load_si512(a + i), _mm512_load_si512(b + i));
+    if (streaming) {
+      _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + i), result);
+    } else {
+      _mm512_store_si512(dst + i, result);
+    }
+  }
+#endif
+  for (; i + 4 <= n; i += 4) {
+    auto result = Op::apply(_mm256_load_si256(reinterpret_cast<const __m256i*>(a + i)),
+                            _mm256_load_si256(reinterpret_cast<const __m256i*>(b + i)));
+    if (streaming) {
+      _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), result);
+    } else {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), result);
+    }
+  }
+  for (; i < n; ++i) {
+    dst[i] = Op::apply(a[i], b[i]);
+  }
+  if (streaming) {
+    _mm_sfence();
   }
-  return result;
 }
 
-BitStream& BitStream::operator&=(const BitStream& other) {
-  assert(blocks.size() == other.blocks.size() && "sizes must be same");
+} // namespace
+
+size_t BitStream::streaming_threshold() {
+  static const size_t threshold = []() -> size_t {
+    auto llc = ::sysconf(_SC_LEVEL3_CACHE_SIZE);
+    return llc > 0 ? static_cast<size_t>(llc) : 32ULL << 20;
+  }();
+  return threshold;
+}
 
-  for (auto i = 0; i < other.blocks.size(); ++i) {
-    blocks[i] &= other.blocks[i];
+uint64_t stream::add_blocks(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t n, uint64_t carry, bool streaming) {
+  const auto mask = _mm256_set1_epi64x(static_cast<int64_t>(BLOCK_MASK));
+  const auto lanes = _mm256_set_epi64x(3, 2, 1, 0);
+  const auto one = _mm256_set1_epi64x(1);
+  for (size_t group = 0; group < n; group += 64) {
+    auto count = std::min<size_t>(64, n - group);
+    auto* d = dst + group;
+
+    // the sum of two blocks fits into 64 bits: bit 63 generates a carry, a sum of 63 ones propagates one
+    uint64_t generate = 0;
+    uint64_t propagate = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      auto sum = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + group + i)),
+                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + group + i)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), sum);
+      generate |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(sum))) << i;
+      propagate |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(sum, mask)))) << i;
+    }
+    for (; i < count; ++i) {
+      d[i] = a[group + i] + b[group + i];
+      generate |= (d[i] >> 63) << i;
+      propagate |= static_cast<uint64_t>(d[i] == BLOCK_MASK) << i;
+    }
+
+    // generate and propagate are disjoint, so adding them resolves all carries of the group at once:
+    // bit i of the result xor propagate is the carry into block i
+    auto resolved = static_cast<unsigned __int128>(propagate) + (static_cast<unsigned __int128>(generate) << 1) + carry;
+    auto carries = static_cast<uint64_t>(resolved) ^ propagate;
+    carry = static_cast<uint64_t>(resolved >> count) & 1;
+
+    i = 0;
+    for (; i + 4 <= count; i += 4) {
+      auto carry_in = _mm256_and_si256(_mm256_srlv_epi64(_mm256_set1_epi64x(static_cast<int64_t>(carries >> i)), lanes), one);
+      auto sum = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+      auto result = _mm256_and_si256(_mm256_add_epi64(sum, carry_in), mask);
+      if (streaming && reinterpret_cast<uintptr_t>(d + i) % 32 == 0) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + i), result);
+      } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), result);
+      }
+    }
+    for (; i < count; ++i) {
+      d[i] = (d[i] + ((carries >> i) & 1)) & BLOCK_MASK;
+    }
   }
+  if (streaming) {
+    _mm_sfence();
+  }
+  return carry;
+}
 
+BitStream& BitStream::assign_and(const BitStream& a, const BitStream& b) {
+  assert(a.blocks.size() == b.blocks.size() && "sizes must be same");
+  resize_like(a);
+  auto streaming = blocks.size() * sizeof(block_type) >= streaming_threshold();
+  transform<And>(blocks.data(), a.blocks.data(), b.blocks.data(), blocks.size(), streaming);
   return *this;
 }
 
-BitStream& BitStream::operator|=(const BitStream& other) {
-  assert(blocks.size() == other.blocks.size() && "sizes must be same");
+BitStream& BitStream::assign_or(const BitStream& a, const BitStream& b) {
+  assert(a.blocks.size() == b.blocks.size() && "sizes must be same");
+  resize_like(a);
+  auto streaming = blocks.size() * sizeof(block_type) >= streaming_threshold();
+  transform<Or>(blocks.data(), a.blocks.data(), b.blocks.data(), blocks.size(), streaming);
+  return *this;
+}
 
-  for (auto i = 0; i < other.blocks.size(); ++i) {
-    blocks[i] |= other.blocks[i];
-  }
+BitStream& BitStream::assign_xor(const BitStream& a, const BitStream& b) {
+  assert(a.blocks.size() == b.blocks.size() && "sizes must be same");
+  resize_like(a);
+  auto streaming = blocks.size() * sizeof(block_type) >= streaming_threshold();
+  transform<Xor>(blocks.data(), a.blocks.data(), b.blocks.data(), blocks.size(), streaming);
+  return *this;
+}
 
+BitStream& BitStream::assign_and_not(const BitStream& a, const BitStream& b) {
+  assert(a.blocks.size() == b.blocks.size() && "sizes must be same");
+  resize_like(a);
+  auto streaming = blocks.size() * sizeof(block_type) >= streaming_threshold();
+  transform<AndNot>(blocks.data(), a.blocks.data(), b.blocks.data(), blocks.size(), streaming);
   return *this;
 }
 
-BitStream& BitStream::operator^=(const BitStream& other) {
-  assert(blocks.size() == other.blocks.size() && "sizes must be same");
+BitStream& BitStream::assign_not(const BitStream& a) {
+  resize_like(a);
+  auto streaming = blocks.size() * sizeof(block_type) >= streaming_threshold();
+  transform<Not>(blocks.data(), a.blocks.data(), a.blocks.data(), blocks.size(), streaming);
+  return *this;
+}
+
+BitStream& BitStream::assign_add(const BitStream& a, const BitStream& b) {
+  assert(a.blocks.size() == b.blocks.size() && "sizes must be same");
+  resize_like(a);
 
-  for (auto i = 0; i < other.blocks.size(); ++i) {
-    blocks[i] ^= other.blocks[i];
+  auto n = blocks.size();
+  auto streaming = n * sizeof(block_type) >= streaming_threshold();
+  auto threads = static_cast<size_t>(std::max(1U, std::thread::hardware_concurrency()));
+  if (n < parallel_blocks || threads == 1) {
+    add_blocks(blocks.data(), a.blocks.data(), b.blocks.data(), n, 0, streaming);
+    return *this;
+  }
+
+  // every segment is added without an incoming carry
+  auto segments = std::min(threads, n / (parallel_blocks / 4));
+  std::vector<size_t> bounds(segments + 1);
+  std::vector<block_type> carries(segments);
+  for (size_t s = 0; s <= segments; ++s) {
+    bounds[s] = n * s / segments;
+  }
+  std::vector<std::thread> workers;
+  for (size_t s = 0; s < segments; ++s) {
+    workers.emplace_back([&, s]() {
+      auto begin = bounds[s];
+      carries[s] = add_blocks(blocks.data() + begin, a.blocks.data() + begin, b.blocks.data() + begin, bounds[s + 1] - begin, 0, streaming);
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
   }
 
+  // the incoming carry of a segment is added afterwards, it stops at the first block that is not all ones
+  block_type carry = 0;
+  for (size_t s = 0; s < segments; ++s) {
+    auto i = bounds[s];
+    for (; carry && i < bounds[s + 1]; ++i) {
+      auto sum = blocks[i] + 1;
+      carry = sum >> bits_per_block;
+      blocks[i] = sum & BLOCK_MASK;
+    }
+    // a segment cannot produce a carry of its own and pass the incoming carry through at the same time
+    carry |= carries[s];
+  }
   return *this;
 }
 
-BitStream& BitStream::operator>>=(const size_t offset) {
-  bool carry = false;
-  for (auto& block : blocks) {
-    bool next_carry = (block >> (bits_per_block - 1)) & 1;
-    block <<= offset;
-    block &= ~(1ULL << bits_per_block);
-    block |= carry;
-    carry = next_carry;
+BitStream& BitStream::assign_shift(const BitStream& a, size_t offset) {
+  assert(offset > 0 && offset < bits_per_block && "offset must be within a block");
+  resize_like(a);
+
+  // dst[i] = (a[i] << offset | a[i - 1] >> (63 - offset)) & mask
+  // from back to front, so a block of `a` is read before the same block of this stream is written
+  auto n = blocks.size();
+  auto streaming = n * sizeof(block_type) >= streaming_threshold();
+  auto* dst = blocks.data();
+  auto* src = a.blocks.data();
+  auto scalar = [&](size_t i) {
+    auto carry = i > 0 ? src[i - 1] >> (bits_per_block - offset) : 0;
+    dst[i] = ((src[i] << offset) | carry) & BLOCK_MASK;
+  };
+
+  auto i = n;
+  for (; i % 4 != 0; --i) {
+    scalar(i - 1);
+  }
+  auto left = _mm_cvtsi64_si128(static_cast<int64_t>(offset));
+  auto right = _mm_cvtsi64_si128(static_cast<int64_t>(bits_per_block - offset));
+  auto mask = _mm256_set1_epi64x(static_cast<int64_t>(BLOCK_MASK));
+  for (; i > 4; i -= 4) {
+    auto current = _mm256_load_si256(reinterpret_cast<const __m256i*>(src + i - 4));
+    auto previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i - 5));
+    auto result = _mm256_or_si256(_mm256_sll_epi64(current, left), _mm256_srl_epi64(previous, right));
+    result = _mm256_and_si256(result, mask);
+    if (streaming) {
+      _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i - 4), result);
+    } else {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i - 4), result);
+    }
+  }
+  for (; i > 0; --i) {
+    scalar(i - 1);
+  }
+  if (streaming) {
+    _mm_sfence();
   }
   return *this;
 }
 
-BitStream& BitStream::operator+=(const BitStream& other) {
-  assert(blocks.size() == other.blocks.size() && "sizes must be same");
+BitStream BitStream::operator&(const BitStream& other) const {
+  BitStream result;
+  return result.assign_and(*this, other);
+}
 
-  bool carry = 0;
-  for (auto i = 0; i < other.blocks.size(); ++i) {
-    blocks[i] += other.blocks[i] + carry;
-    carry = (blocks[i] >> bits_per_block) & 1;
-    blocks[i] &= ~(1ULL << bits_per_block);
-  }
+BitStream BitStream::operator|(const BitStream& other) const {
+  BitStream result;
+  return result.assign_or(*this, other);
+}
 
-  return *this;
+BitStream BitStream::operator^(const BitStream& other) const {
+  BitStream result;
+  return result.assign_xor(*this, other);
+}
+
+BitStream BitStream::operator+(const BitStream& other) const {
+  BitStream result;
+  return result.assign_add(*this, other);
+}
+
+BitStream BitStream::operator>>(const size_t offset) const {
+  BitStream result;
+  return result.assign_shift(*this, offset);
+}
+
+BitStream BitStream::operator~() const {
+  BitStream result;
+  return result.assign_not(*this);
+}
+
+BitStream& BitStream::operator&=(const BitStream& other) {
+  return assign_and(*this, other);
+}
+
+BitStream& BitStream::operator|=(const BitStream& other) {
+  return assign_or(*this, other);
+}
+
+BitStream& BitStream::operator^=(const BitStream& other) {
+  return assign_xor(*this, other);
+}
+
+BitStream& BitStream::operator>>=(const size_t offset) {
+  return assign_shift(*this, offset);
+}
+
+BitStream& BitStream::operator+=(const BitStream& other) {
+  return assign_add(*this, other);
 }
 
 void BitStream::set(size_t pos, bool value) {
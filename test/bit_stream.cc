@@ -154,4 +154,87 @@ namespace {
     ASSERT_EQ(a.pop_count(), expected_count);
   }
 
+  TEST(BitStreamTest, ThreeOperandFormsMultipleVectors) {
+    // 23 blocks cover the vector loops and the scalar tails
+    const size_t length = 63 * 23;
+    BitStream a(length);
+    BitStream b(length);
+    for (size_t i = 0; i < length; ++i) {
+      a.set(i, rand() % 2);
+      b.set(i, rand() % 3 == 0);
+    }
+
+    BitStream c_and, c_or, c_xor, c_and_not, c_not;
+    c_and.assign_and(a, b);
+    c_or.assign_or(a, b);
+    c_xor.assign_xor(a, b);
+    c_and_not.assign_and_not(a, b);
+    c_not.assign_not(a);
+
+    for (size_t i = 0; i < length; ++i) {
+      ASSERT_EQ(c_and.is_set(i), a.is_set(i) && b.is_set(i));
+      ASSERT_EQ(c_or.is_set(i), a.is_set(i) || b.is_set(i));
+      ASSERT_EQ(c_xor.is_set(i), a.is_set(i) != b.is_set(i));
+      ASSERT_EQ(c_and_not.is_set(i), a.is_set(i) && !b.is_set(i));
+      ASSERT_EQ(c_not.is_set(i), !a.is_set(i));
+    }
+  }
+
+  TEST(BitStreamTest, ShiftInPlaceMultipleVectors) {
+    const size_t length = 63 * 23;
+    BitStream a(length);
+    for (size_t i = 0; i < length; ++i) {
+      a.set(i, rand() % 2);
+    }
+    BitStream expected = a;
+
+    a.assign_shift(a, 1);
+
+    ASSERT_FALSE(a.is_set(0));
+    for (size_t i = 1; i < length; ++i) {
+      ASSERT_EQ(a.is_set(i), expected.is_set(i - 1));
+    }
+  }
+
+  TEST(BitStreamTest, AdditionCarryLookahead) {
+    // carries that are generated inside a group of 64 blocks, cross groups and ripple through runs of ones
+    const size_t length = 63 * 200;
+    BitStream a(length);
+    BitStream b(length);
+    for (size_t i = 0; i < length; ++i) {
+      auto ones = (i / 63) % 7 == 3 || (i >= 63 * 60 && i < 63 * 140);
+      a.set(i, ones || rand() % 2);
+      b.set(i, !ones && rand() % 4 == 0);
+    }
+
+    auto c = a + b;
+
+    bool carry = false;
+    for (size_t i = 0; i < length; ++i) {
+      auto sum = a.is_set(i) + b.is_set(i) + carry;
+      ASSERT_EQ(c.is_set(i), sum & 1) << i;
+      carry = sum > 1;
+    }
+  }
+
+  TEST(BitStreamTest, AdditionParallelSegments) {
+    // long runs of ones carry across the segment borders of the threads
+    const size_t blocks = BitStream::parallel_blocks + 1000;
+    BitStream a(blocks * 63);
+    BitStream b(blocks * 63);
+    for (size_t i = 0; i < blocks; ++i) {
+      auto ones = (i / 1000) % 3 == 1 || i > blocks / 2;
+      a.data()[i] = ones ? ~(1ULL << 63) : (static_cast<uint64_t>(rand()) << 32 | rand()) & ~(1ULL << 63);
+      b.data()[i] = ones ? 0 : static_cast<uint64_t>(rand()) << 32;
+    }
+
+    auto c = a + b;
+
+    std::vector<uint64_t> expected(blocks);
+    stream::add_blocks(expected.data(), a.data(), b.data(), blocks, 0);
+    for (size_t i = 0; i < blocks; ++i) {
+      ASSERT_EQ(c.data()[i], expected[i]) << i;
+    }
+  }
+
 } // namespace
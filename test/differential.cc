@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+#include "fuzz/differential.h"
+
+namespace {
+
+  void expect_agree(fuzz::Differential& differential, const fuzz::Case& c) {
+    auto results = differential.run(c);
+    for (auto& result : results) {
+      EXPECT_EQ(result.matched, results[0].matched) << result.engine << " differs from " << results[0].engine << " on " << c;
+    }
+  }
+
+  TEST(DifferentialTest, RegexOracle) {
+    // end positions: "a" at 1, "a1" at 2, "a12" at 3 and the second "a" at 5
+    EXPECT_EQ(fuzz::Differential::regex_count({"a[0-9]*", "a12xa"}), 4);
+    // a leading star still needs its character class at the start of the match
+    EXPECT_EQ(fuzz::Differential::regex_count({"a*b", "b"}), 0);
+    EXPECT_EQ(fuzz::Differential::regex_count({"a*b", "aab"}), 1);
+  }
+
+  TEST(DifferentialTest, MatchBehindFullBlocks) {
+    fuzz::Differential differential({});
+    expect_agree(differential, {"[2-3]", std::string(63, '3')});
+    expect_agree(differential, {"a[0-9]*z", std::string(62, '.') + "a"});
+    expect_agree(differential, {"a[0-9]*", std::string(62, '.') + "a"});
+    expect_agree(differential, {"a*", ""});
+  }
+
+  TEST(DifferentialTest, RandomCases) {
+    fuzz::Differential::Options options;
+    options.seed = 7;
+    options.max_length = 300;
+    options.max_regex_length = 128;
+    fuzz::Differential differential(options);
+    for (auto i = 0; i < 100; ++i) {
+      auto c = differential.next();
+      ASSERT_TRUE(differential.check(c)) << "reproducer: " << differential.shrink(c);
+    }
+  }
+
+} // namespace
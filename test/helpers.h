@@ -0,0 +1,33 @@
+// ---------------------------------------------------------------------------
+#ifndef TEST_HELPERS_H_
+#define TEST_HELPERS_H_
+// ---------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "parabix/dfa.h"
+#include "parser/re_parser.h"
+// ---------------------------------------------------------------------------
+namespace test {
+// ---------------------------------------------------------------------------
+/// Random input over the characters of the test patterns, equal seeds produce equal inputs.
+inline std::string random_input(size_t size, unsigned seed) {
+  std::string result(size, ' ');
+  for (auto& c : result) {
+    c = "ab0123z."[rand_r(&seed) % 8];
+  }
+  return result;
+}
+// ---------------------------------------------------------------------------
+/// Count the match end positions of the pattern with the DFA, the reference of the other engines.
+inline uint64_t dfa_count(const char* pattern, const std::string& input) {
+  parser::ReParser parser;
+  parabix::DFA dfa(parser.parse(pattern));
+  return dfa.match(input.data(), input.size());
+}
+// ---------------------------------------------------------------------------
+} // namespace test
+// ---------------------------------------------------------------------------
+#endif  // TEST_HELPERS_H_
+// ---------------------------------------------------------------------------
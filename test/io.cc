@@ -0,0 +1,74 @@
+#include <zlib.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "gtest/gtest.h"
+#include "io/read_ahead.h"
+#include "io/source.h"
+#include "parabix/matcher.h"
+
+namespace {
+
+  std::string text(size_t size) {
+    std::string result(size, ' ');
+    unsigned seed = 21;
+    for (auto& c : result) {
+      c = "a0123z.\n"[rand_r(&seed) % 8];
+    }
+    return result;
+  }
+
+  std::string read_all(io::ReadAhead& reader) {
+    std::string result;
+    for (auto buffer = reader.next(); !buffer.empty(); buffer = reader.next()) {
+      // all buffers but the last hold whole blocks
+      EXPECT_EQ(result.size() % 63, 0);
+      result += buffer;
+    }
+    return result;
+  }
+
+  TEST(IoTest, ReadAheadPlainAndGzip) {
+    auto input = text(100000);
+    auto plain = testing::TempDir() + "io_plain.txt";
+    auto gzip = testing::TempDir() + "io_gzip.txt.gz";
+    std::ofstream(plain) << input;
+    auto* file = gzopen(gzip.c_str(), "wb");
+    gzwrite(file, input.data(), static_cast<unsigned>(input.size()));
+    gzclose(file);
+
+    EXPECT_FALSE(io::is_compressed(plain));
+    EXPECT_TRUE(io::is_compressed(gzip));
+    for (auto& path : {plain, gzip}) {
+      // small buffers and a short ring, the reader has to wait for the consumer
+      io::ReadAhead reader(io::open(path), 1000, 2);
+      EXPECT_EQ(read_all(reader), input);
+    }
+    // direct I/O rounds the buffers to whole pages and blocks
+    io::ReadAhead direct(std::make_unique<io::DirectFileSource>(plain), 1000, 2);
+    EXPECT_EQ(read_all(direct), input);
+    std::remove(plain.c_str());
+    std::remove(gzip.c_str());
+  }
+
+  TEST(IoTest, StreamEqualsWholeInput) {
+    parabix::Matcher matcher("a[0-9]*z");
+    auto input = text(5000);
+    auto expected = matcher.match(input.data(), input.size());
+    for (size_t part : {1, 62, 63, 64, 1000}) {
+      parabix::Matcher::Scratch scratch;
+      matcher.start(scratch);
+      uint64_t matched = 0;
+      for (size_t pos = 0; pos < input.size(); pos += part) {
+        matched += matcher.feed(scratch, input.data() + pos, std::min(part, input.size() - pos));
+      }
+      matched += matcher.finish(scratch);
+      EXPECT_EQ(matched, expected) << "parts of " << part;
+    }
+  }
+
+  TEST(IoTest, MissingFile) {
+    EXPECT_THROW(io::open("/nonexistent/input"), std::runtime_error);
+  }
+
+} // namespace
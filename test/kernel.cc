@@ -0,0 +1,28 @@
+#include <stdexcept>
+#include <string>
+#include "gtest/gtest.h"
+#include "test/helpers.h"
+#include "test_rules.h"
+
+namespace {
+
+  TEST(KernelTest, GeneratedMatchesDfa) {
+    auto input = test::random_input(1 << 20, 41);
+    for (size_t pos = 1000; pos + 500 < input.size(); pos += 100000) {
+      // matches that carry over many blocks
+      std::fill_n(input.begin() + pos, 500, '1');
+      input[pos] = 'a';
+      input[pos + 499] = 'z';
+    }
+    for (auto size : {size_t{0}, size_t{62}, size_t{63}, size_t{1000}, input.size()}) {
+      uint64_t counts[test_rules::PATTERNS];
+      test_rules::match_all(input.data(), size, counts);
+      for (size_t i = 0; i < test_rules::PATTERNS; ++i) {
+        EXPECT_EQ(counts[i], test::dfa_count(test_rules::patterns[i], input.substr(0, size))) << test_rules::patterns[i] << " " << size;
+        EXPECT_EQ(test_rules::match(i, input.data(), size), counts[i]);
+      }
+    }
+    EXPECT_THROW(test_rules::match(test_rules::PATTERNS, input.data(), input.size()), std::runtime_error);
+  }
+
+} // namespace
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <atomic>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "codegen/bytecode_compiler.h"
+#include "codegen/cc_compiler.h"
+#include "parabix/bit.h"
+#include "parabix/dfa.h"
+#include "parabix/interpreter.h"
+#include "parabix/matcher.h"
+#include "parabix/parabix.h"
+#include "parabix/tiered.h"
+#include "parser/re_parser.h"
+#include "test/helpers.h"
+
+namespace {
+
+  TEST(MatcherTest, ConcurrentCallers) {
+    const parabix::Matcher matcher("a[0-9]*z");
+    std::vector<std::string> inputs;
+    std::vector<uint64_t> expected;
+    for (unsigned t = 0; t < 8; ++t) {
+      inputs.push_back(test::random_input(10000 + t * 37, t));
+      expected.push_back(test::dfa_count("a[0-9]*z", inputs.back()));
+    }
+
+    std::vector<uint64_t> matched(inputs.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < inputs.size(); ++t) {
+      threads.emplace_back([&, t]() {
+        // every call starts from a clean scratch
+        for (auto i = 0; i < 20; ++i) {
+          matched[t] = matcher.match(inputs[t].data(), inputs[t].size());
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(matched, expected);
+  }
+
+  TEST(MatcherTest, ScratchSharedBetweenMatchers) {
+    parabix::Matcher short_matcher("z");
+    parabix::Matcher long_matcher("a[0-9]*[0-9]*bz");
+    parabix::Matcher::Scratch scratch;
+    auto input = test::random_input(1000, 3);
+    for (auto i = 0; i < 2; ++i) {
+      EXPECT_EQ(long_matcher.match(scratch, input.data(), input.size()), test::dfa_count("a[0-9]*[0-9]*bz", input));
+      EXPECT_EQ(short_matcher.match(scratch, input.data(), input.size()), test::dfa_count("z", input));
+    }
+
+    // a moved matcher keeps its compiled code
+    auto moved = std::move(long_matcher);
+    EXPECT_EQ(moved.match(input.data(), input.size()), test::dfa_count("a[0-9]*[0-9]*bz", input));
+  }
+
+  TEST(MatcherTest, FirstMatches) {
+    const parabix::Matcher matcher("a[0-9]*z");
+    auto input = test::random_input(100000, 21);
+    auto total = test::dfa_count("a[0-9]*z", input);
+    for (uint64_t limit : {1, 2, 7, 100, 1000}) {
+      auto first = matcher.match_first(input.data(), input.size(), limit);
+      ASSERT_EQ(first.matched, limit);
+      // the offset is the end of the last counted match
+      EXPECT_EQ(test::dfa_count("a[0-9]*z", input.substr(0, first.offset)), limit);
+      EXPECT_EQ(test::dfa_count("a[0-9]*z", input.substr(0, first.offset - 1)), limit - 1);
+    }
+    auto all = matcher.match_first(input.data(), input.size(), total + 1);
+    EXPECT_EQ(all.matched, total);
+    EXPECT_EQ(all.offset, input.size());
+    auto none = matcher.match_first(input.data(), input.size(), 0);
+    EXPECT_EQ(none.matched, 0);
+    EXPECT_EQ(none.offset, 0);
+    EXPECT_EQ(matcher.match_first("xaz", 3).offset, 3);
+  }
+
+  TEST(MatcherTest, Spans) {
+    unsigned seed = 25;
+    for (auto* pattern : {"a[0-9]*z", "b[0-9]*", "[a-z][0-9]*[0-9]", "0[0-9]*[a-z]*1"}) {
+      const parabix::Matcher matcher(pattern);
+      for (auto i = 0; i < 5; ++i) {
+        auto input = test::random_input(rand_r(&seed) % 3000, seed);
+        // posix extended regular expressions are leftmost-longest
+        std::vector<parabix::Span> expected;
+        std::regex regex(pattern, std::regex::extended);
+        for (auto it = std::sregex_iterator(input.begin(), input.end(), regex); it != std::sregex_iterator(); ++it) {
+          auto begin = static_cast<size_t>(it->position());
+          expected.push_back({begin, begin + it->length()});
+        }
+        EXPECT_EQ(matcher.match_spans(input.data(), input.size()), expected) << pattern << " on " << input;
+      }
+    }
+    const parabix::Matcher matcher("ab[0-9]*");
+    EXPECT_EQ(matcher.match_spans("xab12ab", 7), (std::vector<parabix::Span>{{1, 5}, {5, 7}}));
+  }
+
+  TEST(MatcherTest, TieredHandOver) {
+    auto input = test::random_input(4 << 20, 27);
+    for (size_t pos = 100000; pos + 20000 < input.size(); pos += 100000) {
+      // long matches carry over the chunk boundaries
+      std::fill_n(input.begin() + pos, 20000, '1');
+      input[pos] = 'a';
+      input[pos + 19999] = 'z';
+    }
+    auto expected = test::dfa_count("a[0-9]*z", input);
+    parabix::TieredMatcher matcher("a[0-9]*z");
+    parabix::Stats stats;
+    // usually interpreted at first and compiled later, the counts do not depend on it
+    EXPECT_EQ(matcher.match(input.data(), input.size(), &stats), expected);
+    EXPECT_EQ(stats.bytes_processed, input.size());
+    matcher.wait();
+    ASSERT_TRUE(matcher.compiled());
+    parabix::Stats compiled_stats;
+    EXPECT_EQ(matcher.match(input.data(), input.size(), &compiled_stats), expected);
+    EXPECT_EQ(compiled_stats.blocks_interpreted, 0);
+    parabix::Matcher::Options options;
+    options.delimiter = '\n';
+    EXPECT_THROW(parabix::TieredMatcher("a[0-9]*z", options), std::runtime_error);
+  }
+
+  TEST(MatcherTest, InterpreterCarriesToMatcher) {
+    const char* pattern = "a[0-9]*z";
+    auto input = test::random_input(100000, 29);
+    const size_t handover = 700;
+    auto offset = handover * 63;
+    // a star that is active at the handover and ends behind it
+    std::fill_n(input.begin() + offset - 2000, 4000, '1');
+    input[offset - 2000] = 'a';
+    input[offset + 1999] = 'z';
+
+    parser::ReParser parser;
+    parabix::Interpreter interpreter(parser.parse(pattern));
+    std::vector<std::array<uint64_t, 8>> basis(handover);
+    parabix::transpose_blocks(input.data(), input.size(), 0, handover, basis.data());
+    uint64_t skipped = 0;
+    auto matched = interpreter.run(basis.data(), handover, skipped);
+    auto& carry = interpreter.getCarries();
+    ASSERT_NE(std::count(carry.begin(), carry.end(), 1), 0);
+
+    const parabix::Matcher matcher(pattern);
+    parabix::Matcher::Scratch scratch;
+    matcher.start(scratch, carry);
+    matched += matcher.feed(scratch, input.data() + offset, input.size() - offset);
+    matched += matcher.finish(scratch);
+    EXPECT_EQ(matched, test::dfa_count(pattern, input));
+  }
+
+  TEST(MatcherTest, InterpreterBatches) {
+    auto input = test::random_input(1 << 20, 31);
+    for (auto pattern : {"a[0-9]*z", "ab[0-9]*.", "[a-z0-9]*z", "[b-z]b*0"}) {
+      // batches of blocks and the carries between them
+      EXPECT_EQ(parabix::parabix_cpp(input, pattern), test::dfa_count(pattern, input)) << pattern;
+    }
+
+    // equal character classes share their instructions
+    parser::ReParser parser;
+    codegen::CCCompiler cc_compiler;
+    std::vector<std::unique_ptr<codegen::BitwiseExpression>> expressions;
+    for (auto& cc : parser.parse("[0-9][0-9]x")) {
+      expressions.push_back(cc_compiler.compile(cc));
+    }
+    codegen::BytecodeCompiler bytecode_compiler;
+    auto bytecode = bytecode_compiler.compile(expressions);
+    EXPECT_EQ(bytecode.getOutputs()[0], bytecode.getOutputs()[1]);
+  }
+
+  TEST(MatcherTest, Parallel) {
+    const parabix::Matcher matcher("a[0-9]*z");
+    parabix::ThreadPool pool(4);
+    // large enough for 4 segments of at least 2^16 blocks, one per worker
+    auto input = test::random_input(16 << 20, 13);
+    auto blocks = input.size() / 63 + 1;
+    auto boundary = [&](size_t i) { return blocks * i / 4 * 63; };
+    auto run = [&](size_t begin, size_t end, char last) {
+      std::fill(input.begin() + begin, input.begin() + end, '1');
+      input[begin] = 'a';
+      input[end - 1] = last;
+    };
+    // a match across the first boundary, a star that does not match across the second
+    run(boundary(1) - 1000, boundary(1) + 1000, 'z');
+    run(boundary(2) - 3000, boundary(2) - 1000, '.');
+    run(boundary(2) - 500, boundary(2) + 500, '.');
+    // a match that spans the whole third segment, the fix-up never converges within it
+    run(boundary(2) + 2000, boundary(3) + 500, 'z');
+    EXPECT_EQ(matcher.match_parallel(input.data(), input.size(), pool), test::dfa_count("a[0-9]*z", input));
+    EXPECT_EQ(matcher.match_parallel(input.data(), 1000, pool), test::dfa_count("a[0-9]*z", input.substr(0, 1000)));
+  }
+
+  TEST(MatcherTest, NestedPoolTasks) {
+    parabix::ThreadPool pool(2);
+    parabix::ThreadPool::Group outer;
+    std::atomic<int> done{0};
+    for (auto i = 0; i < 8; ++i) {
+      pool.submit(outer, [&]() {
+        // waiting workers run the inner tasks themselves
+        parabix::ThreadPool::Group inner;
+        for (auto j = 0; j < 8; ++j) {
+          pool.submit(inner, [&]() { done.fetch_add(1); });
+        }
+        pool.wait(inner);
+      });
+    }
+    pool.wait(outer);
+    EXPECT_EQ(done.load(), 64);
+  }
+
+  TEST(MatcherTest, ColumnRows) {
+    parabix::Matcher::Options options;
+    options.records = true;
+    parabix::Matcher matcher("a[0-9]*z", options);
+    unsigned seed = 11;
+    std::vector<std::string> values = {"a1", "2z", "", "a12z", "xxaz"};
+    for (auto i = 0; i < 500; ++i) {
+      // empty rows, short rows and rows around the block size
+      values.push_back(test::random_input(rand_r(&seed) % 130, seed));
+    }
+    std::vector<int32_t> offsets = {0};
+    std::string data;
+    for (auto& value : values) {
+      data += value;
+      offsets.push_back(static_cast<int32_t>(data.size()));
+    }
+
+    auto bitmap = matcher.match_column(offsets.data(), values.size(), data.data());
+    ASSERT_EQ(bitmap.size(), (values.size() + 7) / 8);
+    // "a1" and "2z" only match across the row boundary
+    EXPECT_EQ(bitmap[0] & 0x1F, 0b11000);
+    for (size_t row = 0; row < values.size(); ++row) {
+      EXPECT_EQ((bitmap[row / 8] >> (row % 8)) & 1, test::dfa_count("a[0-9]*z", values[row]) > 0) << "row " << row << ": " << values[row];
+    }
+
+    std::vector<int64_t> large_offsets(offsets.begin(), offsets.end());
+    EXPECT_EQ(matcher.match_column(large_offsets.data(), values.size(), data.data()), bitmap);
+  }
+
+  TEST(MatcherTest, ColumnMatchAtRowEnd) {
+    parabix::Matcher::Options options;
+    options.records = true;
+    parabix::Matcher matcher("b[0-9]*", options);
+    std::vector<std::string> values = {"xb", "1", std::string(62, '.') + "b", "", std::string(63, '1'), "b12"};
+    std::vector<int32_t> offsets = {0};
+    std::string data;
+    for (auto& value : values) {
+      data += value;
+      offsets.push_back(static_cast<int32_t>(data.size()));
+    }
+    EXPECT_EQ(matcher.match_column(offsets.data(), values.size(), data.data()), std::vector<uint8_t>{0b100101});
+  }
+
+  void expect_records(const parabix::Matcher& matcher, const char* pattern, const std::string& input, char delimiter) {
+    std::vector<std::string> records;
+    std::string record;
+    for (auto c : input) {
+      if (c == delimiter) {
+        records.push_back(record);
+        record.clear();
+      } else {
+        record += c;
+      }
+    }
+    if (!record.empty()) {
+      records.push_back(record);
+    }
+
+    auto result = matcher.match_records(input.data(), input.size());
+    ASSERT_EQ(result.count, records.size());
+    ASSERT_EQ(result.bitmap.size(), (records.size() + 7) / 8);
+    uint64_t matched = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+      auto expected = test::dfa_count(pattern, records[i]) > 0;
+      matched += expected;
+      EXPECT_EQ((result.bitmap[i / 8] >> (i % 8)) & 1, expected) << "record " << i << ": " << records[i];
+    }
+    EXPECT_EQ(result.matched, matched);
+  }
+
+  TEST(MatcherTest, NewlineRecords) {
+    parabix::Matcher::Options options;
+    options.delimiter = '\n';
+    parabix::Matcher matcher("a[0-9]*z", options);
+    expect_records(matcher, "a[0-9]*z", "", '\n');
+    expect_records(matcher, "a[0-9]*z", "a1\n2z\naz", '\n');
+    expect_records(matcher, "a[0-9]*z", "a1\n2z\naz\n", '\n');
+    expect_records(matcher, "a[0-9]*z", std::string(62, '.') + "az\n\n" + std::string(63, '.') + "a", '\n');
+    unsigned seed = 5;
+    for (auto i = 0; i < 20; ++i) {
+      auto input = test::random_input(rand_r(&seed) % 2000, seed);
+      for (auto& c : input) {
+        c = c == '.' ? '\n' : c;
+      }
+      expect_records(matcher, "a[0-9]*z", input, '\n');
+    }
+  }
+
+  TEST(MatcherTest, NulRecords) {
+    parabix::Matcher::Options options;
+    options.delimiter = '\0';
+    parabix::Matcher matcher("b[0-9]*", options);
+    auto input = test::random_input(5000, 9);
+    for (auto& c : input) {
+      c = c == '.' ? '\0' : c;
+    }
+    expect_records(matcher, "b[0-9]*", input, '\0');
+    expect_records(matcher, "b[0-9]*", std::string("b1\0", 3), '\0');
+  }
+
+  TEST(MatcherTest, CsvField) {
+    parabix::Matcher::Options options;
+    options.records = true;
+    parabix::Matcher matcher("a[0-9]*z", options);
+    unsigned seed = 17;
+    std::string input;
+    std::vector<bool> expected;
+    for (auto row = 0; row < 300; ++row) {
+      unsigned fields = rand_r(&seed) % 4;
+      auto matched = false;
+      for (unsigned field = 0; field < fields; ++field) {
+        auto value = test::random_input(rand_r(&seed) % 40, seed);
+        if (rand_r(&seed) % 3 == 0) {
+          // separators and newlines inside quotes belong to the field
+          value = "\"a1,\n" + value + "z\"";
+        }
+        if (field == 1) {
+          matched = test::dfa_count("a[0-9]*z", value) > 0;
+        }
+        input += (field > 0 ? "," : "") + value;
+      }
+      input += "\n";
+      expected.push_back(matched);
+    }
+    // the last row misses its newline
+    input += ",xxa12z";
+    expected.push_back(true);
+
+    auto result = matcher.match_field(input.data(), input.size(), 1);
+    ASSERT_EQ(result.count, expected.size());
+    uint64_t matched = 0;
+    for (size_t row = 0; row < expected.size(); ++row) {
+      matched += expected[row];
+      EXPECT_EQ((result.bitmap[row / 8] >> (row % 8)) & 1, expected[row]) << "row " << row;
+    }
+    EXPECT_EQ(result.matched, matched);
+    EXPECT_EQ(matcher.match_field(",xxa12z", 7, 0).matched, 0);
+    EXPECT_EQ(matcher.match_field(",xxa12z", 7, 1).matched, 1);
+  }
+
+} // namespace
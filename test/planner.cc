@@ -0,0 +1,53 @@
+#include <string>
+#include "gtest/gtest.h"
+#include "parabix/dfa.h"
+#include "parabix/literal.h"
+#include "parabix/parabix.h"
+#include "parabix/planner.h"
+#include "parser/re_parser.h"
+#include "test/helpers.h"
+
+namespace {
+
+  parabix::Plan plan(const char* pattern, size_t size) {
+    parser::ReParser parser;
+    return parabix::plan(parser.parse(pattern), size);
+  }
+
+  TEST(PlannerTest, ChoosesEngine) {
+    auto literal = plan("ab0", 100);
+    EXPECT_EQ(literal.engine, parabix::Engine::Literal);
+    EXPECT_EQ(literal.literal, "ab0");
+    EXPECT_EQ(plan("a[0-9]*z", 1000).engine, parabix::Engine::DFA);
+    EXPECT_EQ(plan("a[0-9]*z", 1ULL << 20).engine, parabix::Engine::Interpreter);
+    EXPECT_EQ(plan("a[0-9]*z", 1ULL << 30).engine, parabix::Engine::JIT);
+    EXPECT_EQ(plan("a[0-9]*z[0-9]*z[0-9]*z[0-9]*z[0-9]*z[0-9]*z", 1000).engine, parabix::Engine::Interpreter);
+    EXPECT_GT(plan("[a-z][0-9]", 1000).operations, 0);
+  }
+
+  TEST(PlannerTest, LiteralCount) {
+    parser::ReParser parser;
+    for (auto* literal : {"a", "ab", "z.a", "0123", "aaa"}) {
+      for (unsigned seed = 0; seed < 5; ++seed) {
+        auto input = test::random_input(seed * 97 + 5, seed);
+        input += "aaaa";
+        parabix::DFA dfa(parser.parse(literal));
+        EXPECT_EQ(parabix::literal_count(input.data(), input.size(), literal), dfa.match(input.data(), input.size())) << literal;
+      }
+    }
+    EXPECT_EQ(parabix::literal_count("ab", 2, "abc"), 0);
+  }
+
+  TEST(PlannerTest, PlannedMatchesEveryEngine) {
+    llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
+    parser::ReParser parser;
+    auto input = test::random_input(20000, 3);
+    for (auto* pattern : {"ab", "a[0-9]*z", "a[0-9]*z[0-9]*z[0-9]*z[0-9]*z[0-9]*z[0-9]*z"}) {
+      parabix::Stats stats;
+      parabix::DFA dfa(parser.parse(pattern));
+      EXPECT_EQ(parabix::parabix_planned(context, input, pattern, codegen::OptimizationLevel::O2, &stats), dfa.match(input.data(), input.size())) << pattern;
+      EXPECT_NE(stats.plan, nullptr);
+    }
+  }
+
+} // namespace
@@ -0,0 +1,48 @@
+#include <regex>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "parabix/replace.h"
+#include "test/helpers.h"
+
+namespace {
+
+  std::string replace_in_parts(const parabix::Matcher& matcher, const std::string& input, const std::string& replacement, size_t part) {
+    std::string result;
+    parabix::Replacer replacer(matcher, replacement, [&result](const std::vector<std::string_view>& pieces) {
+      for (auto piece : pieces) {
+        result.append(piece);
+      }
+    });
+    for (size_t pos = 0; pos < input.size(); pos += part) {
+      replacer.feed(input.data() + pos, std::min(part, input.size() - pos));
+    }
+    replacer.finish();
+    return result;
+  }
+
+  TEST(ReplaceTest, EqualsRegexReplace) {
+    unsigned seed = 31;
+    for (auto* pattern : {"a[0-9]*z", "b[0-9]*", "[a-z][0-9]*[0-9]"}) {
+      const parabix::Matcher matcher(pattern);
+      std::regex regex(pattern, std::regex::extended);
+      for (auto i = 0; i < 5; ++i) {
+        auto input = test::random_input(rand_r(&seed) % 5000, seed);
+        auto expected = std::regex_replace(input, regex, "<$&>");
+        EXPECT_EQ(parabix::replace(matcher, input.data(), input.size(), "<&>"), expected) << pattern;
+        // parts that end inside blocks and inside matches
+        for (size_t part : {1, 7, 63, 100, 4096}) {
+          EXPECT_EQ(replace_in_parts(matcher, input, "<&>", part), expected) << pattern << " in parts of " << part;
+        }
+      }
+    }
+  }
+
+  TEST(ReplaceTest, LongMatchAcrossParts) {
+    const parabix::Matcher matcher("a[0-9]*z");
+    auto input = "x" + std::string("a") + std::string(10000, '1') + "z.a1";
+    EXPECT_EQ(replace_in_parts(matcher, input, "\\&", 500), "x&.a1");
+    EXPECT_EQ(replace_in_parts(matcher, "", "-", 500), "");
+  }
+
+} // namespace
@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <initializer_list>
+#include <vector>
+#include "gtest/gtest.h"
+#include "operations/simd.h"
+
+namespace {
+
+  std::vector<uint8_t> random_stream(size_t size, int one_in) {
+    std::vector<uint8_t> result(size);
+    for (auto& position : result) {
+      position = rand() % one_in == 0;
+    }
+    return result;
+  }
+
+  TEST(SimdTest, MatchStarRippleCarry) {
+    // sizes that are not a multiple of 64 and runs that cross the groups of 64 positions
+    for (auto size : std::initializer_list<size_t>{1, 63, 64, 65, 200, 1000}) {
+      auto marker = random_stream(size, 8);
+      auto cc = random_stream(size, 2);
+      for (auto i = size / 3; i < size / 2; ++i) {
+        cc[i] = 1;
+      }
+
+      auto result = operation::simd::match_star(marker, cc);
+
+      // ripple carry reference
+      uint8_t carry = 0;
+      for (size_t i = 0; i < size; ++i) {
+        auto value = marker[i] & cc[i];
+        auto sum = value + cc[i] + carry;
+        carry = sum >> 1;
+        ASSERT_EQ(result[i], ((sum & 1) ^ cc[i]) | marker[i]) << size << ": " << i;
+      }
+    }
+  }
+
+  TEST(SimdTest, ChunksContinueTheCarry) {
+    const size_t size = 1000;
+    auto marker = random_stream(size, 4);
+    auto cc = random_stream(size, 2);
+    auto expected_star = operation::simd::match_star(marker, cc);
+    auto expected_advance = operation::simd::advance(marker, cc);
+
+    std::vector<uint8_t> star(size), advance(size);
+    uint64_t star_carry = 0, advance_carry = 0;
+    for (size_t begin = 0, chunk = 37; begin < size; begin += chunk) {
+      auto length = std::min(chunk, size - begin);
+      star_carry = operation::simd::match_star(star.data() + begin, marker.data() + begin, cc.data() + begin, length, star_carry);
+      advance_carry = operation::simd::advance(advance.data() + begin, marker.data() + begin, cc.data() + begin, length, advance_carry);
+    }
+
+    ASSERT_EQ(star, expected_star);
+    ASSERT_EQ(advance, expected_advance);
+    ASSERT_EQ(advance[0], 0);
+    for (size_t i = 1; i < size; ++i) {
+      ASSERT_EQ(advance[i], marker[i - 1] & cc[i - 1]);
+    }
+  }
+
+} // namespace
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
+#include <llvm-c/Target.h>
+#include <llvm/Support/DynamicLibrary.h>
 
 int main(int argc, char *argv[]) {
+    LLVMInitializeNativeTarget();
+    LLVMInitializeNativeAsmPrinter();
+    llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
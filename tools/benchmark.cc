@@ -1,123 +1,336 @@
-#include <bits/stdc++.h>
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <chrono> // NOLINT
+#include <iomanip>
+#include <iostream>
 #include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include <llvm-c/Target.h>
 #include <llvm/Support/DynamicLibrary.h>
+#include "generator/input_generator.h"
+#include "parabix/dfa.h"
+#include "parabix/matcher.h"
 #include "parabix/parabix.h"
+#include "parabix/tiered.h"
+#include "parser/re_parser.h"
 
-struct State {
-  std::unordered_map<uint8_t, uint8_t> next;
-  bool final = false;
+namespace {
 
-  State() {
-    for (auto i = 0; i < 256; ++i) {
-      next[i] = 0;
-    }
-  }
+const size_t BLOCK_SIZE = 63;
+
+enum class Format {
+  Table,
+  CSV,
+  JSON,
+};
+
+struct Options {
+  std::vector<std::string> patterns;
+  std::vector<size_t> sizes_in_mb;
+  std::vector<std::string> engines;
+  std::vector<unsigned> threads;
+  unsigned warmups = 1;
+  unsigned repetitions = 5;
+  uint64_t seed = 42;
+  double selectivity = 0.1;
+  Format format = Format::Table;
 };
 
-uint64_t std_regex(std::string& input, const char* pattern) {
-  std::regex r1(pattern);
-  auto words_begin = std::sregex_iterator(input.begin(), input.end(), r1);
-  auto words_end = std::sregex_iterator();
+// A single run of an engine over all segments
+struct Measurement {
+  uint64_t matched = 0;
+  double compile_seconds = 0;
+  double scan_seconds = 0;
+};
+
+// The aggregated runs of a matrix cell
+struct Result {
+  std::string pattern;
+  size_t size;
+  std::string engine;
+  unsigned threads;
+  uint64_t matched;
+  double compile_median;
+  double scan_median;
+  double scan_p95;
+  double gbps;
+};
 
-  return std::distance(words_begin, words_end);
+void print_help(const char* name) {
+  std::cerr << "usage: " << name << " [options]\n"
+            << "  --pattern=REGEX        pattern to benchmark, repeatable (default: a[0-9]*z)\n"
+            << "  --size=MB              input size in MB, repeatable (default: 10, 100)\n"
+            << "  --engine=NAME          std::regex, DFA, parabix-cpp, parabix-llvm, parabix-matcher,\n"
+            << "                         parabix-planned or parabix-tiered, repeatable (default: all)\n"
+            << "  --threads=N            number of threads, repeatable (default: 1)\n"
+            << "  --warmup=N             warmup runs per cell (default: 1)\n"
+            << "  --repetitions=N        measured runs per cell (default: 5)\n"
+            << "  --seed=N               seed of the input generator (default: 42)\n"
+            << "  --selectivity=F        fraction of generated lines that match (default: 0.1)\n"
+            << "  --format=table|csv|json\n";
 }
 
-uint64_t DFA(std::string& input, const char* pattern) {
-  assert(strcmp(pattern, "a[0-9]*z") == 0 && "DFA can only handle 'a[0-9]*z'");
-  // pattern: a[0-9]*z
-  std::vector<State> states(4);
-  states[3].final = true;
+bool parse_options(int argc, char** argv, Options& options) {
+  for (auto i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    auto separator = arg.find('=');
+    if (arg.substr(0, 2) != "--" || separator == std::string::npos) {
+      return false;
+    }
+    auto name = arg.substr(2, separator - 2);
+    auto value = arg.substr(separator + 1);
+    if (name == "pattern") {
+      options.patterns.push_back(value);
+    } else if (name == "size") {
+      options.sizes_in_mb.push_back(std::stoull(value));
+    } else if (name == "engine") {
+      options.engines.push_back(value);
+    } else if (name == "threads") {
+      options.threads.push_back(std::stoul(value));
+    } else if (name == "warmup") {
+      options.warmups = std::stoul(value);
+    } else if (name == "repetitions") {
+      options.repetitions = std::max(1UL, std::stoul(value));
+    } else if (name == "seed") {
+      options.seed = std::stoull(value);
+    } else if (name == "selectivity") {
+      options.selectivity = std::stod(value);
+    } else if (name == "format" && value == "table") {
+      options.format = Format::Table;
+    } else if (name == "format" && value == "csv") {
+      options.format = Format::CSV;
+    } else if (name == "format" && value == "json") {
+      options.format = Format::JSON;
+    } else {
+      return false;
+    }
+  }
+  if (options.patterns.empty()) options.patterns = {"a[0-9]*z"};
+  if (options.sizes_in_mb.empty()) options.sizes_in_mb = {10, 100};
+  if (options.engines.empty()) options.engines = {"std::regex", "DFA", "parabix-cpp", "parabix-llvm", "parabix-matcher", "parabix-planned", "parabix-tiered"};
+  if (options.threads.empty()) options.threads = {1};
+  for (auto& engine : options.engines) {
+    if (engine != "std::regex" && engine != "DFA" && engine != "parabix-cpp" && engine != "parabix-llvm" && engine != "parabix-matcher" && engine != "parabix-planned" &&
+        engine != "parabix-tiered") {
+      std::cerr << "unknown engine: " << engine << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
 
-  // current = root or first char 'a' and next -> a
-  states[0].next['a'] = 1;
-  states[1].next['a'] = 1;
+// Split the input into block aligned segments, one per thread.
+// Matches that cross a segment border are not counted by any engine, so counts stay comparable.
+std::vector<std::string> split_input(const std::string& input, unsigned threads) {
+  auto blocks = input.size() / BLOCK_SIZE;
+  std::vector<std::string> segments;
+  for (unsigned t = 0; t < threads; ++t) {
+    auto begin = blocks * t / threads * BLOCK_SIZE;
+    auto end = blocks * (t + 1) / threads * BLOCK_SIZE;
+    segments.emplace_back(input.substr(begin, end - begin));
+  }
+  return segments;
+}
 
-  // current = 'a' and next -> [0-9]* or z
-  for (char c = '0'; c <= '9'; ++c) {
-    states[1].next[c] = 2; // next -> [0-9]*
+Measurement run_segment(const std::string& engine, std::string& segment, const char* pattern) {
+  Measurement measurement;
+  auto tick = std::chrono::steady_clock::now();
+  if (engine == "std::regex") {
+    std::regex regex(pattern);
+    auto tock = std::chrono::steady_clock::now();
+    measurement.compile_seconds = std::chrono::duration<double>(tock - tick).count();
+    auto begin = std::sregex_iterator(segment.begin(), segment.end(), regex);
+    measurement.matched = std::distance(begin, std::sregex_iterator());
+    measurement.scan_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tock).count();
+  } else if (engine == "DFA") {
+    parser::ReParser parser;
+    parabix::DFA dfa(parser.parse(pattern));
+    auto tock = std::chrono::steady_clock::now();
+    measurement.compile_seconds = std::chrono::duration<double>(tock - tick).count();
+    measurement.matched = dfa.match(segment.data(), segment.size());
+    measurement.scan_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tock).count();
+  } else {
+    parabix::Stats stats;
+    if (engine == "parabix-cpp") {
+      measurement.matched = parabix::parabix_cpp(segment, pattern, &stats);
+    } else if (engine == "parabix-tiered") {
+      // the compilation overlaps with the scan, the scan time includes the interpreted blocks
+      parabix::TieredMatcher matcher(pattern);
+      measurement.matched = matcher.match(segment.data(), segment.size(), &stats);
+    } else if (engine == "parabix-planned") {
+      llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
+      measurement.matched = parabix::parabix_planned(context, segment, pattern, codegen::OptimizationLevel::O2, &stats);
+    } else {
+      // llvm contexts must not be shared between threads
+      llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
+      measurement.matched = parabix::parabix_llvm(context, segment, pattern, false, codegen::OptimizationLevel::O2, &stats);
+    }
+    measurement.compile_seconds = stats.compile_seconds();
+    measurement.scan_seconds = stats.scan_seconds();
   }
-  // z
-  states[1].next['z'] = 3; // next -> z
+  return measurement;
+}
 
-  // current = '[0-9]' and next -> [0-9]* or z
-  states[2].next['a'] = 1;
-  for (char c = '0'; c <= '9'; ++c) {
-    states[2].next[c] = 2; // next -> [0-9]*
+// All threads share a single compiled matcher, the compile time is paid once.
+std::vector<Measurement> run_shared_matcher(std::vector<std::string>& segments, const char* pattern) {
+  parabix::Matcher matcher(pattern);
+  std::vector<Measurement> measurements(segments.size());
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < segments.size(); ++t) {
+    threads.emplace_back([&, t]() {
+      parabix::Stats stats;
+      measurements[t].matched = matcher.match(segments[t].data(), segments[t].size(), &stats);
+      measurements[t].compile_seconds = matcher.getStatistics().compile_seconds();
+      measurements[t].scan_seconds = stats.scan_seconds();
+    });
   }
-  // z
-  states[2].next['z'] = 3; // next -> z
-
-  uint64_t matched = 0, current_state_idx = 0;
-  for (auto& c : input) {
-    current_state_idx = states[current_state_idx].next[c];
-    if (states[current_state_idx].final) {
-      current_state_idx = 0;
-      matched++;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return measurements;
+}
+
+Measurement run(const std::string& engine, std::vector<std::string>& segments, const char* pattern) {
+  std::vector<Measurement> measurements(segments.size());
+  if (engine == "parabix-matcher") {
+    measurements = run_shared_matcher(segments, pattern);
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < segments.size(); ++t) {
+      threads.emplace_back([&, t]() { measurements[t] = run_segment(engine, segments[t], pattern); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
     }
   }
-  return matched;
+
+  // the slowest thread determines the elapsed time
+  Measurement result;
+  for (auto& measurement : measurements) {
+    result.matched += measurement.matched;
+    result.compile_seconds = std::max(result.compile_seconds, measurement.compile_seconds);
+    result.scan_seconds = std::max(result.scan_seconds, measurement.scan_seconds);
+  }
+  return result;
+}
+
+double percentile(std::vector<double> values, double p) {
+  std::sort(values.begin(), values.end());
+  auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+  return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
 }
 
+void print_results(const std::vector<Result>& results, Format format) {
+  switch (format) {
+    case Format::Table:
+      std::cout << std::setw(16) << std::left << "pattern" << std::setw(12) << std::right << "size"
+                << std::setw(17) << "engine" << std::setw(8) << "threads" << std::setw(12) << "matched"
+                << std::setw(14) << "compile [ms]" << std::setw(14) << "median [ms]" << std::setw(14) << "p95 [ms]"
+                << std::setw(10) << "GB/s" << std::endl;
+      for (auto& r : results) {
+        std::cout << std::setw(16) << std::left << r.pattern << std::setw(12) << std::right << r.size
+                  << std::setw(17) << r.engine << std::setw(8) << r.threads << std::setw(12) << r.matched
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << r.compile_median * 1000 << std::setw(14) << r.scan_median * 1000
+                  << std::setw(14) << r.scan_p95 * 1000 << std::setw(10) << r.gbps << std::endl;
+      }
+      break;
+    case Format::CSV:
+      std::cout << "pattern,size,engine,threads,matched,compile_median_s,scan_median_s,scan_p95_s,gbps" << std::endl;
+      for (auto& r : results) {
+        // patterns may contain quotes and commas
+        std::string pattern;
+        for (auto c : r.pattern) {
+          pattern += c == '"' ? std::string("\"\"") : std::string(1, c);
+        }
+        std::cout << '"' << pattern << "\"," << r.size << ',' << r.engine << ',' << r.threads << ',' << r.matched << ','
+                  << r.compile_median << ',' << r.scan_median << ',' << r.scan_p95 << ',' << r.gbps << std::endl;
+      }
+      break;
+    case Format::JSON:
+      for (auto& r : results) {
+        std::string pattern;
+        for (auto c : r.pattern) {
+          if (c == '"' || c == '\\') pattern += '\\';
+          pattern += c;
+        }
+        std::cout << "{\"pattern\":\"" << pattern << "\",\"size\":" << r.size << ",\"engine\":\"" << r.engine
+                  << "\",\"threads\":" << r.threads << ",\"matched\":" << r.matched
+                  << ",\"compile_median_s\":" << r.compile_median << ",\"scan_median_s\":" << r.scan_median
+                  << ",\"scan_p95_s\":" << r.scan_p95 << ",\"gbps\":" << r.gbps << "}" << std::endl;
+      }
+      break;
+  }
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    print_help(argv[0]);
+    return 1;
+  }
 
   LLVMInitializeNativeTarget();
   LLVMInitializeNativeAsmPrinter();
   llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
-  llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
-
-  auto pattern = "a[0-9]*z";
-  std::vector<std::string> files = {"10mb.txt", "50mb.txt", "100mb.txt", "500mb.txt", "1gb.txt"};
-  std::vector<std::string> algorithms = {"std::regex", "DFA", "parabix-cpp", "parabix-llvm"};
-  std::vector<std::vector<double>> elapsed_times(files.size(), std::vector<double>(algorithms.size()));
-
-  for (auto i = 0; i < files.size(); ++i) {
-
-    auto rf_tick = std::chrono::high_resolution_clock::now();
-    std::ifstream t("../input/" + files[i]);
-    std::stringstream buffer;
-    buffer << t.rdbuf();
-    auto input = buffer.str();
-    std::vector<uint64_t> results;
-    for (auto j = 0; j < algorithms.size(); ++j) {
-      auto tick = std::chrono::high_resolution_clock::now();
-
-      if (algorithms[j] == "std::regex") {
-        results.push_back(std_regex(input, pattern));
-      } else if (algorithms[j] == "DFA") {
-        results.push_back(DFA(input, pattern));
-      } else if (algorithms[j] == "parabix-cpp") {
-        results.push_back(parabix::parabix_cpp(input, pattern));
-      } else {
-        results.push_back(parabix::parabix_llvm(context, input, pattern, false));
-      }
 
-      auto tock = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double> elapsed_time = tock - tick;
-      elapsed_times[i][j] = elapsed_time.count();
-    }
+  std::vector<Result> results;
+  auto mismatch = false;
+  for (auto& pattern : options.patterns) {
+    for (auto size_in_mb : options.sizes_in_mb) {
+      generator::InputGenerator::Options generator_options;
+      generator_options.pattern = pattern;
+      generator_options.selectivity = options.selectivity;
+      generator_options.seed = options.seed;
+      generator_options.threads = std::max(1U, std::thread::hardware_concurrency());
+      auto input = generator::InputGenerator(generator_options).generate(size_in_mb * 1024 * 1024);
+      for (auto threads : options.threads) {
+        auto segments = split_input(input, threads);
+        std::vector<std::pair<std::string, uint64_t>> matches;
+        for (auto& engine : options.engines) {
+          for (unsigned w = 0; w < options.warmups; ++w) {
+            run(engine, segments, pattern.c_str());
+          }
+          std::vector<double> compile_times, scan_times;
+          uint64_t matched = 0;
+          for (unsigned r = 0; r < options.repetitions; ++r) {
+            auto measurement = run(engine, segments, pattern.c_str());
+            matched = measurement.matched;
+            compile_times.push_back(measurement.compile_seconds);
+            scan_times.push_back(measurement.scan_seconds);
+          }
+          auto scan_median = percentile(scan_times, 0.5);
+          results.push_back({
+            pattern, input.size(), engine, threads, matched,
+            percentile(compile_times, 0.5), scan_median, percentile(scan_times, 0.95),
+            static_cast<double>(input.size()) / scan_median / 1e9
+          });
+          matches.emplace_back(engine, matched);
+        }
 
-    for (auto l = 0; l < results.size() - 1; ++l) {
-      if (results[l] != results[l + 1]) {
-        std::cerr << "results must be same - " << l << " = " << l + 1 << std::endl;
-        exit(1);
+        // std::regex counts non-overlapping matches, the other engines count match end positions
+        std::pair<std::string, uint64_t>* reference = nullptr;
+        for (auto& match : matches) {
+          if (match.first == "std::regex") {
+            continue;
+          }
+          if (reference && reference->second != match.second) {
+            std::cerr << "results must be same - " << pattern << ": " << reference->first << " = " << reference->second
+                      << ", " << match.first << " = " << match.second << std::endl;
+            mismatch = true;
+          }
+          reference = reference ? reference : &match;
+        }
       }
     }
   }
 
-  std::cout << std::setw(10) << std::left << "size/algo";
-  for (auto& algo : algorithms) {
-    std::cout << std::setw(20) << std::right << algo;
-  }
-  std::cout << std::endl;
-  for (auto i = 0; i < files.size(); ++i) {
-    std::cout << std::setw(10) << std::left << files[i];
-    for (auto j = 0; j < algorithms.size(); ++j) {
-      std::cout << std::setw(20) << std::right << std::setprecision(2) << elapsed_times[i][j];
-    }
-    std::cout << std::endl;
-  }
+  print_results(results, options.format);
 
-  return 0;
+  return mismatch ? 1 : 0;
 }
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <llvm-c/Target.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include "fuzz/differential.h"
+
+void print_help(const char* name) {
+  std::cerr << "usage: " << name << " [options]\n"
+            << "  --iterations=N         number of random cases (default: 1000)\n"
+            << "  --seed=N               seed, equal seeds produce equal cases (default: 42)\n"
+            << "  --max-length=N         maximum input length (default: 1024)\n"
+            << "  --max-cc=N             maximum number of character classes (default: 6)\n"
+            << "  --max-regex-length=N   maximum input length checked with std::regex (default: 256)\n"
+            << "  --no-llvm              skip the JIT compiled engine\n";
+}
+
+int main(int argc, char** argv) {
+  fuzz::Differential::Options options;
+  uint64_t iterations = 1000;
+  for (auto i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    auto separator = arg.find('=');
+    auto name = arg.substr(0, separator);
+    auto value = separator == std::string::npos ? std::string() : arg.substr(separator + 1);
+    if (name == "--iterations") {
+      iterations = std::stoull(value);
+    } else if (name == "--seed") {
+      options.seed = std::stoull(value);
+    } else if (name == "--max-length") {
+      options.max_length = std::stoull(value);
+    } else if (name == "--max-cc") {
+      options.max_cc = std::max(1ULL, std::stoull(value));
+    } else if (name == "--max-regex-length") {
+      options.max_regex_length = std::stoull(value);
+    } else if (name == "--no-llvm") {
+      options.llvm = false;
+    } else {
+      print_help(argv[0]);
+      exit(1);
+    }
+  }
+
+  LLVMInitializeNativeTarget();
+  LLVMInitializeNativeAsmPrinter();
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
+  fuzz::Differential differential(options);
+  for (uint64_t i = 0; i < iterations; ++i) {
+    auto c = differential.next();
+    if (differential.check(c)) {
+      continue;
+    }
+
+    std::cerr << "mismatch in case " << i << ": " << c << std::endl;
+    auto reproducer = differential.shrink(c);
+    std::cerr << "reproducer: " << reproducer << std::endl;
+    for (auto& result : differential.run(reproducer)) {
+      std::cerr << "  " << result.engine << " = " << result.matched << std::endl;
+    }
+    return 1;
+  }
+  std::cout << iterations << " cases passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "codegen/kernel_compiler_cpp.h"
+
+void print_help(const char* name) {
+  std::cerr << "usage: " << name << " [options] [regex...]\n"
+            << "  writes the scan kernel of the patterns to <output>/<name>.h and <output>/<name>.cc\n"
+            << "  --name=NAME            namespace and file name of the kernel (default: matcher)\n"
+            << "  --output=DIR           output directory (default: .)\n";
+}
+
+void write_file(const std::string& path, const std::string& content) {
+  // keep the file untouched if nothing changed, so dependent objects are not rebuilt
+  std::ifstream in(path);
+  std::string existing((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (in && existing == content) {
+    return;
+  }
+  std::ofstream out(path, std::ios::trunc);
+  out << content;
+  if (!out) {
+    throw std::runtime_error{"cannot write " + path};
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string name = "matcher";
+  std::string output = ".";
+  std::vector<std::string> patterns;
+  for (auto i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    auto separator = arg.find('=');
+    auto option = arg.substr(0, separator);
+    auto value = separator == std::string::npos ? std::string() : arg.substr(separator + 1);
+    if (option == "--name") {
+      name = value;
+    } else if (option == "--output") {
+      output = value;
+    } else if (arg.rfind("--", 0) == 0) {
+      print_help(argv[0]);
+      exit(1);
+    } else {
+      patterns.push_back(arg);
+    }
+  }
+  if (patterns.empty()) {
+    print_help(argv[0]);
+    exit(1);
+  }
+
+  try {
+    codegen::KernelCompilerCpp compiler;
+    auto kernel = compiler.compile(name, patterns);
+    write_file(output + "/" + name + ".h", kernel.header);
+    write_file(output + "/" + name + ".cc", kernel.source);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
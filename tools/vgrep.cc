@@ -11,7 +11,7 @@
 #include "codegen/expression_compiler_cpp.h"
 #include "codegen/expression_compiler_llvm.h"
 #include "stream/bit_stream.h"
-#include "operations/marker.h"
+#include "operations/lazy.h"
 
 void print_help(const char* name) {
   std::cerr << "usage: " << name << " [/path/to/file] [regex]" << std::endl;
@@ -40,7 +40,6 @@ int main(int argc, char** argv) {
   auto tick = std::chrono::high_resolution_clock::now();
 
   parser::ReParser parser;
-  codegen::CCCompiler cc_compiler;
 
   auto cc_list = parser.parse(pattern);
   auto input_size = input.length();
@@ -54,6 +53,7 @@ int main(int argc, char** argv) {
   LLVMInitializeNativeAsmPrinter();
   llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
   llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
+  codegen::CCCompiler cc_compiler;
   std::vector<std::unique_ptr<codegen::BitwiseExpression>> expressions;
   for (auto& cc : cc_list) {
     auto expression = cc_compiler.compile(cc);
@@ -73,7 +73,7 @@ int main(int argc, char** argv) {
   expr_compiler.compile(expressions, false);
 
   // CC bit streams
-  std::vector<stream::BitStream> cc_bit_streams(cc_size, stream::BitStream(input_size));
+  std::vector<stream::BitStream> cc_bit_streams(cc_size, stream::BitStream(input_size + 1));
   for (size_t i = 0; i < input_size; ++i) {
     std::vector<uint8_t> match_result(cc_size);
     expr_compiler.run(input[i], reinterpret_cast<uint8_t*>(match_result.data()));
@@ -81,33 +81,27 @@ int main(int argc, char** argv) {
       cc_bit_streams[j].set(i, match_result[j]);
     }
   }
+  auto cc_stream = [&](size_t i) { return operation::lazy::erase(operation::lazy::ref(cc_bit_streams[i])); };
 #else
-  std::vector<stream::BitStream> cc_bit_streams(cc_size, stream::BitStream(input_size));
-  for (size_t i = 0; i < input_size; ++i) {
-    for (size_t j = 0; j < cc_size; ++j) {
-      cc_bit_streams[j].set(i, cc_list[j].match(input[i]));
-    }
-  }
-
+  // the character classes are computed tile by tile from the text, no stream is materialized
+  auto cc_stream = [&](size_t i) { return operation::lazy::erase(operation::lazy::chars(input.data(), input_size, cc_list[i])); };
 #endif
 
-  
-  // Marker bit streams
-  auto markers_size = cc_size + 1;
-  std::vector<stream::BitStream> markers(markers_size, stream::BitStream(input_size));
-  markers[0] = cc_bit_streams[0];
-  for (size_t i = 0; i < markers_size - 1; ++i) {
+  // Marker bit streams, the whole chain is fused into a single pass over cache sized tiles
+  auto marker = cc_stream(0);
+  for (size_t i = 0; i < cc_size; ++i) {
     if (cc_list[i].isStar()) {
-      markers[i + 1] = operation::marker::match_star(markers[i], cc_bit_streams[i]);
+      marker = operation::lazy::erase(operation::lazy::match_star(std::move(marker), cc_stream(i)));
     } else {
-      markers[i + 1] = operation::marker::advance(markers[i], cc_bit_streams[i]);
+      marker = operation::lazy::erase(operation::lazy::advance(std::move(marker), cc_stream(i)));
     }
   }
+  auto matched = operation::lazy::pop_count(marker, input_size / 63 + 1);
 
   e.stopCounters();
   e.printReport(std::cout, input_size); // use n as scale factor
   
-  std::cout << "matched = " << markers.back().pop_count() << std::endl;
+  std::cout << "matched = " << matched << std::endl;
 
   auto tock = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed_time = tock - tick;
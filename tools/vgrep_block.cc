@@ -8,9 +8,10 @@
 #include <immintrin.h>
 #include "PerfEvent.hpp"
 #include "parabix/parabix.h"
+#include "parabix/telemetry.h"
 
 void print_help(const char* name) {
-  std::cerr << "usage: " << name << " [/path/to/file] [regex]" << std::endl;
+  std::cerr << "usage: " << name << " [/path/to/file] [regex] [--stats] [--telemetry=/path/to/records.jsonl]" << std::endl;
 }
 
 int main(int argc, char** argv) {
@@ -18,6 +19,19 @@ int main(int argc, char** argv) {
     print_help(argv[0]);
     exit(1);
   }
+  auto print_stats = false;
+  std::string telemetry_path;
+  for (auto i = 3; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (arg == "--stats") {
+      print_stats = true;
+    } else if (arg.substr(0, 12) == "--telemetry=") {
+      telemetry_path = arg.substr(12);
+    } else {
+      print_help(argv[0]);
+      exit(1);
+    }
+  }
 
   std::ifstream t(argv[1]);
   std::stringstream buffer;
@@ -28,12 +42,24 @@ int main(int argc, char** argv) {
 
   auto tick = std::chrono::high_resolution_clock::now();
 
+  std::ofstream telemetry_output;
+  parabix::Telemetry telemetry(telemetry_output);
+  if (!telemetry_path.empty()) {
+    telemetry_output.open(telemetry_path);
+    parabix::Telemetry::install(&telemetry);
+  }
+
   PerfEvent e;
   e.startCounters();
 
-  std::cout << "matched = " << parabix::parabix_cpp(input, pattern) << std::endl;
+  parabix::Stats stats;
+  std::cout << "matched = " << parabix::parabix_cpp(input, pattern, &stats) << std::endl;
 
   e.stopCounters();
+  if (print_stats) {
+    std::cout << stats;
+  }
+  parabix::Telemetry::install(nullptr);
   e.printReport(std::cout, input.size()); // use n as scale factor
 
   auto tock = std::chrono::high_resolution_clock::now();
@@ -4,45 +4,350 @@
 #include <iomanip>
 #include <vector>
 #include <numeric>
+#include <optional>
 #include <chrono> // NOLINT
+#include <filesystem>
+#include <mutex>
 #include <immintrin.h>
 #include <llvm-c/Target.h>
 #include <llvm/Support/DynamicLibrary.h>
 #include "PerfEvent.hpp"
+#include "io/read_ahead.h"
+#include "io/source.h"
+#include "parabix/matcher.h"
 #include "parabix/parabix.h"
+#include "parabix/telemetry.h"
+#include "parabix/thread_pool.h"
+#include "parabix/tiered.h"
 
 void print_help(const char* name) {
-  std::cerr << "usage: " << name << " [/path/to/file] [regex]" << std::endl;
+  std::cerr << "usage: " << name << " [/path/to/file] [regex] [-O0|-O1|-O2|-O3] [--stats] [--telemetry=/path/to/records.jsonl] [--records[=nul]] [--field=N] [--stream] [--direct] [--threads=N] [--max-count=N] [--files-with-matches] [--only-matching] [--plan] [--tiered]" << std::endl;
+  std::cerr << "  --tiered interprets the first blocks while the kernel is compiled in the background" << std::endl;
+  std::cerr << "  --plan lets the planner choose between the literal search, the DFA, the interpreter and the JIT" << std::endl;
+  std::cerr << "  --only-matching prints the offset and text of the leftmost-longest matches" << std::endl;
+  std::cerr << "  --max-count stops after N matches, --files-with-matches after the first match of every file" << std::endl;
+  std::cerr << "  a directory is searched recursively, files are matched in parallel and printed in order" << std::endl;
+  std::cerr << "  --stream reads ahead on a reader thread, --direct also bypasses the page cache with O_DIRECT" << std::endl;
+  std::cerr << "  gzip and zstd compressed files are decompressed on a reader thread and always streamed" << std::endl;
+}
+
+// files above this size are split into segments that are matched in parallel
+const uint64_t LARGE_FILE = 64 << 20;
+
+/// Stream the file until the first `limit` match end positions, the offset is the end of the last one.
+/// Small buffers keep the read ahead short, the reading stops with the buffer that reaches the limit.
+parabix::Matcher::First match_first(const parabix::Matcher& matcher, const std::string& path, uint64_t limit, bool direct, parabix::Stats* stats) {
+  parabix::Matcher::First first;
+  if (limit == 0) {
+    return first;
+  }
+  parabix::Matcher::Scratch scratch;
+  matcher.start(scratch);
+  io::ReadAhead reader(io::open(path, direct), 1 << 20, 2);
+  std::vector<uint64_t> ends;
+  for (auto buffer = reader.next();; buffer = reader.next()) {
+    ends.clear();
+    if (buffer.empty()) {
+      matcher.finish(scratch, stats, &ends);
+    } else {
+      matcher.feed(scratch, buffer.data(), buffer.size(), stats, &ends);
+    }
+    first.offset += buffer.size();
+    if (first.matched + ends.size() >= limit) {
+      first.offset = ends[limit - first.matched - 1];
+      first.matched = limit;
+      return first;
+    }
+    first.matched += ends.size();
+    if (buffer.empty()) {
+      return first;
+    }
+  }
+}
+
+/// Read the whole file into a single buffer.
+std::string read_file(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error{"cannot open " + path.string()};
+  }
+  std::string input(std::filesystem::file_size(path), '\0');
+  if (!file.read(input.data(), static_cast<std::streamsize>(input.size()))) {
+    throw std::runtime_error{"cannot read " + path.string()};
+  }
+  return input;
+}
+
+uint64_t match_file(const parabix::Matcher& matcher, const std::filesystem::path& path, parabix::ThreadPool& pool, uint64_t limit) {
+  if (limit != UINT64_MAX) {
+    return match_first(matcher, path.string(), limit, false, nullptr).matched;
+  }
+  // large files are matched in parallel segments, the others are streamed without a copy of the whole file
+  if (!io::is_compressed(path.c_str()) && std::filesystem::file_size(path) > LARGE_FILE) {
+    auto input = read_file(path);
+    return matcher.match_parallel(input.data(), input.size(), pool);
+  }
+  parabix::Matcher::Scratch scratch;
+  matcher.start(scratch);
+  io::ReadAhead reader(io::open(path.c_str()));
+  uint64_t matched = 0;
+  for (auto buffer = reader.next(); !buffer.empty(); buffer = reader.next()) {
+    matched += matcher.feed(scratch, buffer.data(), buffer.size());
+  }
+  return matched + matcher.finish(scratch);
+}
+
+uint64_t match_tree(const parabix::Matcher& matcher, const std::filesystem::path& root, parabix::ThreadPool& pool, uint64_t limit, bool files_with_matches) {
+  std::vector<std::filesystem::path> paths;
+  for (auto& entry : std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied)) {
+    if (entry.is_regular_file()) {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+
+  // the files finish in any order, the results are printed in the order of the paths
+  struct Result {
+    bool done = false;
+    uint64_t matched = 0;
+    std::string error;
+  };
+  std::vector<Result> results(paths.size());
+  std::mutex output;
+  size_t next = 0;
+  uint64_t total = 0;
+  parabix::ThreadPool::Group group;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    pool.submit(group, [&, i]() {
+      Result result;
+      try {
+        result.matched = match_file(matcher, paths[i], pool, files_with_matches ? 1 : limit);
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+      std::lock_guard<std::mutex> lock(output);
+      results[i] = std::move(result);
+      results[i].done = true;
+      for (; next < results.size() && results[next].done; ++next) {
+        if (!results[next].error.empty()) {
+          std::cerr << paths[next].string() << ": " << results[next].error << std::endl;
+        } else if (files_with_matches) {
+          if (results[next].matched > 0) {
+            std::cout << paths[next].string() << "\n";
+          }
+          total += results[next].matched;
+        } else {
+          std::cout << paths[next].string() << ": " << results[next].matched << "\n";
+          total += results[next].matched;
+        }
+      }
+    });
+  }
+  pool.wait(group);
+  return total;
+}
+
+bool parse_level(std::string_view arg, codegen::OptimizationLevel& level) {
+  if (arg == "-O0") {
+    level = codegen::OptimizationLevel::O0;
+  } else if (arg == "-O1") {
+    level = codegen::OptimizationLevel::O1;
+  } else if (arg == "-O2") {
+    level = codegen::OptimizationLevel::O2;
+  } else if (arg == "-O3") {
+    level = codegen::OptimizationLevel::O3;
+  } else {
+    return false;
+  }
+  return true;
 }
 
 int main(int argc, char** argv) {
-  if (argc != 3) {
+  auto level = codegen::OptimizationLevel::O2;
+  auto print_stats = false;
+  std::string telemetry_path;
+  std::optional<char> delimiter;
+  std::optional<unsigned> field;
+  auto stream = false;
+  auto direct = false;
+  auto threads = std::thread::hardware_concurrency();
+  auto limit = UINT64_MAX;
+  auto files_with_matches = false;
+  auto only_matching = false;
+  auto planned = false;
+  auto tiered = false;
+  if (argc < 3) {
     print_help(argv[0]);
     exit(0);
   }
+  for (auto i = 3; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (arg == "--stats") {
+      print_stats = true;
+    } else if (arg.substr(0, 12) == "--telemetry=") {
+      telemetry_path = arg.substr(12);
+    } else if (arg == "--records") {
+      delimiter = '\n';
+    } else if (arg == "--records=nul") {
+      delimiter = '\0';
+    } else if (arg == "--stream") {
+      stream = true;
+    } else if (arg == "--direct") {
+      stream = true;
+      direct = true;
+    } else if (arg.substr(0, 12) == "--max-count=") {
+      limit = std::stoull(std::string(arg.substr(12)));
+    } else if (arg == "--tiered") {
+      tiered = true;
+    } else if (arg == "--plan") {
+      planned = true;
+    } else if (arg == "--only-matching") {
+      only_matching = true;
+    } else if (arg == "--files-with-matches") {
+      files_with_matches = true;
+    } else if (arg.substr(0, 10) == "--threads=") {
+      threads = std::stoul(std::string(arg.substr(10)));
+    } else if (arg.substr(0, 8) == "--field=") {
+      field = std::stoul(std::string(arg.substr(8)));
+    } else if (!parse_level(argv[i], level)) {
+      print_help(argv[0]);
+      exit(0);
+    }
+  }
 
   LLVMInitializeNativeTarget();
   LLVMInitializeNativeAsmPrinter();
   llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
 
-  std::ifstream t(argv[1]);
-  std::stringstream buffer;
-  buffer << t.rdbuf();
+  auto tree = std::filesystem::is_directory(argv[1]);
+  if ((limit != UINT64_MAX || files_with_matches) && (field || delimiter)) {
+    std::cerr << "--max-count and --files-with-matches count match end positions, not records" << std::endl;
+    exit(1);
+  }
+  if (tree && (field || delimiter || stream || only_matching)) {
+    std::cerr << "--records, --field, --stream and --only-matching need a file" << std::endl;
+    exit(1);
+  }
+  stream = !tree && (stream || io::is_compressed(argv[1]));
+  if (stream && (field || delimiter || only_matching)) {
+    std::cerr << "--records, --field and --only-matching need an uncompressed input" << std::endl;
+    exit(1);
+  }
+  // an early exit reads the file only up to the last match that is needed
+  auto first_only = !tree && !only_matching && (limit != UINT64_MAX || files_with_matches);
+  stream = stream && !first_only;
 
-  auto input = buffer.str();
+  if (planned && tiered) {
+    std::cerr << "--plan and --tiered choose different engines" << std::endl;
+    exit(1);
+  }
+  if ((planned || tiered) && (tree || stream || first_only || field || delimiter || only_matching)) {
+    std::cerr << "--plan and --tiered count the matches of a whole uncompressed file" << std::endl;
+    exit(1);
+  }
+
+  std::string input;
+  if (!stream && !tree && !first_only) {
+    std::ifstream t(argv[1]);
+    std::stringstream buffer;
+    buffer << t.rdbuf();
+    input = buffer.str();
+  }
   auto pattern = argv[2];
 
   auto tick = std::chrono::high_resolution_clock::now();
 
   llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
 
+  std::ofstream telemetry_output;
+  parabix::Telemetry telemetry(telemetry_output);
+  if (!telemetry_path.empty()) {
+    telemetry_output.open(telemetry_path);
+    parabix::Telemetry::install(&telemetry);
+  }
+
   PerfEvent e;
   e.startCounters();
 
-  std::cout << "matched = " << parabix::parabix_llvm(context, input, pattern, false) << std::endl;
+  parabix::Stats stats;
+  uint64_t bytes = input.size();
+  parabix::Matcher::Options options;
+  options.level = level;
+  if (tree) {
+    // one compiled matcher for all files
+    parabix::Matcher matcher(context, pattern, options);
+    stats = matcher.getStatistics();
+    parabix::ThreadPool pool(threads);
+    auto matched = match_tree(matcher, argv[1], pool, limit, files_with_matches);
+    std::cout << "matched = " << matched << std::endl;
+  } else if (first_only) {
+    // stop reading with the buffer of the last match that is needed
+    parabix::Matcher matcher(context, pattern, options);
+    stats = matcher.getStatistics();
+    auto first = match_first(matcher, argv[1], files_with_matches ? 1 : limit, direct, &stats);
+    bytes = stats.bytes_processed;
+    std::cout << "matched = " << first.matched << std::endl;
+    std::cout << "offset = " << first.offset << std::endl;
+  } else if (stream) {
+    // the reader thread fills the next buffers while the current one is matched
+    parabix::Matcher matcher(context, pattern, options);
+    stats = matcher.getStatistics();
+    parabix::Matcher::Scratch scratch;
+    matcher.start(scratch);
+    io::ReadAhead reader(io::open(argv[1], direct));
+    uint64_t matched = 0;
+    for (auto buffer = reader.next(); !buffer.empty(); buffer = reader.next()) {
+      matched += matcher.feed(scratch, buffer.data(), buffer.size(), &stats);
+    }
+    matched += matcher.finish(scratch, &stats);
+    bytes = stats.bytes_processed;
+    std::cout << "matched = " << matched << std::endl;
+  } else if (field) {
+    // count the CSV rows whose field contains a match
+    options.records = true;
+    parabix::Matcher matcher(context, pattern, options);
+    stats = matcher.getStatistics();
+    auto rows = matcher.match_field(input.data(), input.size(), *field, {}, &stats);
+    std::cout << "rows = " << rows.count << std::endl;
+    std::cout << "matched rows = " << rows.matched << std::endl;
+  } else if (delimiter) {
+    // count the records with a match instead of the match end positions
+    options.records = true;
+    options.delimiter = delimiter;
+    parabix::Matcher matcher(context, pattern, options);
+    stats = matcher.getStatistics();
+    auto records = matcher.match_records(input.data(), input.size(), &stats);
+    std::cout << "records = " << records.count << std::endl;
+    std::cout << "matched records = " << records.matched << std::endl;
+  } else if (only_matching) {
+    parabix::Matcher matcher(context, pattern, options);
+    stats = matcher.getStatistics();
+    auto spans = matcher.match_spans(input.data(), input.size());
+    for (auto& span : spans) {
+      std::cout << span.begin << ":" << std::string_view(input).substr(span.begin, span.end - span.begin) << "\n";
+    }
+    std::cout << "spans = " << spans.size() << std::endl;
+  } else if (tiered) {
+    parabix::TieredMatcher matcher(pattern, options);
+    std::cout << "matched = " << matcher.match(input.data(), input.size(), &stats) << std::endl;
+  } else if (planned) {
+    std::cout << "matched = " << parabix::parabix_planned(context, input, pattern, level, &stats) << std::endl;
+    std::cout << "plan = " << stats.plan << std::endl;
+  } else if (threads > 1 && input.size() > LARGE_FILE) {
+    parabix::Matcher matcher(context, pattern, options);
+    stats = matcher.getStatistics();
+    parabix::ThreadPool pool(threads);
+    std::cout << "matched = " << matcher.match_parallel(input.data(), input.size(), pool) << std::endl;
+  } else {
+    std::cout << "matched = " << parabix::parabix_llvm(context, input, pattern, false, level, &stats) << std::endl;
+  }
 
   e.stopCounters();
-  e.printReport(std::cout, input.size()); // use n as scale factor
+  if (print_stats) {
+    std::cout << stats;
+  }
+  parabix::Telemetry::install(nullptr);
+  e.printReport(std::cout, std::max<uint64_t>(bytes, 1)); // use n as scale factor
 
   auto tock = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed_time = tock - tick;
@@ -0,0 +1,104 @@
+#include <sys/uio.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono> // NOLINT
+#include <llvm-c/Target.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include "io/read_ahead.h"
+#include "io/source.h"
+#include "parabix/matcher.h"
+#include "parabix/replace.h"
+
+void print_help(const char* name) {
+  std::cerr << "usage: " << name << " [/path/to/file] [regex] [replacement] [-O0|-O1|-O2|-O3] [--direct]" << std::endl;
+  std::cerr << "  writes the input with the leftmost-longest matches replaced to stdout" << std::endl;
+  std::cerr << "  & in the replacement stands for the match, \\& for the character itself" << std::endl;
+}
+
+bool parse_level(std::string_view arg, codegen::OptimizationLevel& level) {
+  if (arg == "-O0") {
+    level = codegen::OptimizationLevel::O0;
+  } else if (arg == "-O1") {
+    level = codegen::OptimizationLevel::O1;
+  } else if (arg == "-O2") {
+    level = codegen::OptimizationLevel::O2;
+  } else if (arg == "-O3") {
+    level = codegen::OptimizationLevel::O3;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/// Write all pieces with as few system calls as possible.
+void write_pieces(int fd, const std::vector<std::string_view>& pieces) {
+  std::vector<iovec> vectors;
+  vectors.reserve(pieces.size());
+  for (auto piece : pieces) {
+    vectors.push_back({const_cast<char*>(piece.data()), piece.size()});
+  }
+  for (size_t first = 0; first < vectors.size();) {
+    auto count = std::min<size_t>(IOV_MAX, vectors.size() - first);
+    auto written = writev(fd, vectors.data() + first, static_cast<int>(count));
+    if (written < 0) {
+      throw std::runtime_error{"cannot write the output"};
+    }
+    // skip the pieces that were written, a partial write continues inside a piece
+    for (auto left = static_cast<size_t>(written); left > 0;) {
+      auto& vector = vectors[first];
+      auto step = std::min(left, vector.iov_len);
+      vector.iov_base = static_cast<char*>(vector.iov_base) + step;
+      vector.iov_len -= step;
+      left -= step;
+      first += vector.iov_len == 0;
+    }
+    for (; first < vectors.size() && vectors[first].iov_len == 0; ++first) {}
+  }
+}
+
+int main(int argc, char** argv) {
+  auto level = codegen::OptimizationLevel::O2;
+  auto direct = false;
+  if (argc < 4) {
+    print_help(argv[0]);
+    exit(0);
+  }
+  for (auto i = 4; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (arg == "--direct") {
+      direct = true;
+    } else if (!parse_level(arg, level)) {
+      print_help(argv[0]);
+      exit(0);
+    }
+  }
+
+  LLVMInitializeNativeTarget();
+  LLVMInitializeNativeAsmPrinter();
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
+  auto tick = std::chrono::high_resolution_clock::now();
+  parabix::Matcher::Options options;
+  options.level = level;
+  parabix::Matcher matcher(argv[2], options);
+  parabix::Replacer replacer(matcher, argv[3], [](const std::vector<std::string_view>& pieces) { write_pieces(STDOUT_FILENO, pieces); });
+  // the reader thread fills the next buffers while the current one is replaced
+  io::ReadAhead reader(io::open(argv[1], direct));
+  uint64_t bytes = 0;
+  for (auto buffer = reader.next(); !buffer.empty(); buffer = reader.next()) {
+    replacer.feed(buffer.data(), buffer.size());
+    bytes += buffer.size();
+  }
+  auto replaced = replacer.finish();
+
+  auto tock = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed_time = tock - tick;
+  std::cerr << "replaced = " << replaced << std::endl;
+  std::cerr << "bytes = " << bytes << std::endl;
+  std::cerr << "elapsed time = " << elapsed_time.count() << " second" << std::endl;
+  return 0;
+}